@@ -5,13 +5,8 @@
  */
 
 #include "Asteroid.h"
-
-static const float kMinSideRatio = 0.80F;
-static const float kMaxSideRatio = 1.30F;
-static const int kMinAsteroidPoints = 6;
-static const int kMaxAsteroidPoints = 12;
-static const float kMinAngleRatio = -0.33F;
-static const float kMaxAngleRatio = 0.33F;
+#include "AsteroidShapeLibrary.h"
+#include "ObjectPool.h"
 
 static const float kMaxChildSizeRatio = 0.75F;
 static const float kMinChildSizeRatio = 0.1F;
@@ -21,7 +16,7 @@ static const float kMaxKnockSpeed = 2 * PI * 3;
 
 const sf::Color Asteroid::kDefaultColor(165, 42, 42);
 
-void Asteroid::knockAsteriod(float minLinearSpeed, float maxLinearSpeed)
+void Asteroid::knockAsteriod(float minLinearSpeed, float maxLinearSpeed, Random &random)
 {
   KnockConfig config;
 
@@ -32,58 +27,25 @@ void Asteroid::knockAsteriod(float minLinearSpeed, float maxLinearSpeed)
   {
     config.maxRadialSpeed *= (mMinChildSize / mCollisionRadius);
   }
-  knockRand(config);
+  knockRand(config, random);
 }
 
-Asteroid::Asteroid(const Config &config) : VolatileObj()
+Asteroid::Asteroid(const Config &config, Random &random) : VolatileObj()
 {
-  int pointCount = randInt(kMinAsteroidPoints, kMaxAsteroidPoints);
-
-  // The triagle fan has a central point (the first point)
-  // and the rest points circle the original.  To complete
-  // the asteroid, we connect the circle with the last
-  // point matching the first point (past the central):
-  // body[0]: Central point
-  // body[1]: First circling point
-  // body[pointCount]: Last unique circling point
-  // body[pointCount + 1]: Connecting point (same as body[1])
-  //
-  int totalPointCount = pointCount + 2;
-
-  sf::VertexArray body(sf::TriangleFan, totalPointCount);
-  body[0].position = sf::Vector2f(0, 0);
-  double nextAngle = 0;
-  double deltaAngle = 2 * PI / pointCount;
-  double size = randFloat(config.minSize, config.maxSize);
-  for (int i = 0; i < pointCount; i++)
-  {
-    double angle = nextAngle + randFloat(kMinAngleRatio, kMaxAngleRatio) * deltaAngle;
-    double len = size * randFloat(kMinSideRatio, kMaxSideRatio);
-    double x = cos(angle) * len;
-    double y = sin(angle) * len;
-    body[(int)(i + 1)].position = sf::Vector2f((float)x, (float)y);
-    nextAngle += deltaAngle;
-  }
-  body[(int)(pointCount + 1)].position = body[1].position;
-  sf::Color darkColor(config.color.r / 2, config.color.g / 2, config.color.b / 2);
-  for (int i = 0; i < totalPointCount; i++)
-  {
-    if (i > 0)
-    {
-      body[i].color = darkColor;
-    }
-    else
-    {
-      body[i].color = config.color;
-    }
-  }
+  // The outline comes from the shared library; only the choice of
+  // outline and its size are made here.
+  mShapeIndex = random.randInt(0, AsteroidShapeLibrary::get().getShapeCount() - 1);
+  mScale = random.randFloat(config.minSize, config.maxSize);
   mMainColor = config.color;
-  mModelShapes.push_back(body);
   mMinChildSize = config.minChildSize;
   
-  // TODO: larger asteroids, with large variances in side radius,
-  //       may need something more precise when detecting a collision...
-  mCollisionRadius = (float)size;
+  // The circle is only close for large asteroids, with large variances
+  // in side radius; the polygon narrowphase tests the outline itself,
+  // within the circle round its farthest point.
+  mCollisionRadius = mScale;
+  mBoundingRadius = AsteroidShapeLibrary::get().getOutline(mShapeIndex).maxRadius * mScale;
+  mType = ObjectType::Asteroid;
+  mIsPassive = true;
 
   if (mMinChildSize > 0)
   {
@@ -95,25 +57,64 @@ Asteroid::Asteroid(const Config &config) : VolatileObj()
   mExplodeStyle = ExplodeStyle::FireOnly;
 }
 
-std::list<std::shared_ptr<GraphObj>> Asteroid::explode()
+GraphObj::CollisionOutline Asteroid::getCollisionOutline() const
 {
-  // Try breaking up into an approximately similar volume
-  std::list<std::shared_ptr<GraphObj>> ejecta;
+  AsteroidShapeLibrary::Outline libraryOutline = AsteroidShapeLibrary::get().getOutline(mShapeIndex);
+  CollisionOutline outline;
+  outline.points = libraryOutline.points;
+  outline.pointCount = libraryOutline.pointCount;
+  outline.innerRadius = libraryOutline.innerRadius;
+  outline.scale = mScale;
+  return outline;
+}
 
-  if (mChildrenAllowed)
+void Asteroid::placeShapes(WorldGeometry *geometry, sf::Vector2f center, AngleFactors angleFact) const
+{
+  // A fan of triangles round the center, lit at the middle and dark at
+  // the edges
+  AsteroidShapeLibrary::Outline outline = AsteroidShapeLibrary::get().getOutline(mShapeIndex);
+  sf::Color darkColor(mMainColor.r / 2, mMainColor.g / 2, mMainColor.b / 2);
+  auto toWorld = [&](sf::Vector2f pt)
+  {
+    pt *= mScale;
+    return sf::Vertex(
+      center + sf::Vector2f(pt.x * angleFact.cosFactor - pt.y * angleFact.sinFactor,
+                            pt.x * angleFact.sinFactor + pt.y * angleFact.cosFactor),
+      darkColor);
+  };
+
+  sf::Vertex hub(center, mMainColor);
+  sf::Vertex first = toWorld(outline.points[0]);
+  sf::Vertex previous = first;
+  for (int index = 1; index <= outline.pointCount; index++)
+  {
+    sf::Vertex next = index < outline.pointCount ? toWorld(outline.points[index]) : first;
+    geometry->triangles.append(hub);
+    geometry->triangles.append(previous);
+    geometry->triangles.append(next);
+    previous = next;
+  }
+}
+
+void Asteroid::explode(std::vector<std::shared_ptr<GraphObj>> *ejecta, UpdateContext *context)
+{
+  // Try breaking up into an approximately similar volume
+  if (mChildrenAllowed && ejecta && context && context->random)
   {
+    Random &random = *context->random;
     float remainingVolume = mCollisionRadius * mCollisionRadius;
+    float minSize = mCollisionRadius * kMinChildSizeRatio;
+    float maxSize = mCollisionRadius * kMaxChildSizeRatio;
 
     Asteroid::Config config;
     config.color = mMainColor;
-    config.minSize = mCollisionRadius * kMinChildSizeRatio;
-    config.maxSize = mCollisionRadius * kMaxChildSizeRatio;
     config.minChildSize = mMinChildSize;
 
     for (int tries = 0; tries < kMaxChildTries; tries++)
     {
-      auto obj = std::make_shared<Asteroid>(config);
-      float size = obj->mCollisionRadius;
+      // Pick the size before building the child, so a child that
+      // doesn't fit is never built.
+      float size = random.randFloat(minSize, maxSize);
       if (size < mMinChildSize)
       {
         break;
@@ -124,20 +125,19 @@ std::list<std::shared_ptr<GraphObj>> Asteroid::explode()
       {
         break;
       }
-      throwObjRand(obj, ThrowStyle::Breakup);
+      config.minSize = size;
+      config.maxSize = size;
+      auto obj = makePooled<Asteroid>(config, random);
+      throwObjRand(obj, random, ThrowStyle::Breakup);
       // Space the objects out 
       obj->setPosition(obj->getPosition() + obj->getDirectionVector() * (mCollisionRadius / 2));
 
       // Reduce the rotation by the size
       obj->setRadialVelocity(obj->getRadialVelocity() * (mMinChildSize / size));
       obj->setTeam(getTeam());
-      ejecta.push_back(obj);
+      ejecta->push_back(obj);
     }
   }
 
-  auto explodeEjecta = VolatileObj::explode();
-  ejecta.splice(ejecta.end(), explodeEjecta);
-  return ejecta;
+  VolatileObj::explode(ejecta, context);
 }
-
-
@@ -9,7 +9,7 @@
 
 #include "VolatileObj.h"
 
-class Asteroid : public VolatileObj
+class Asteroid final : public VolatileObj
 {
 public:
 
@@ -24,13 +24,15 @@ public:
     sf::Color color;
   };
 
-  Asteroid(const Config &config);
+  Asteroid(const Config &config, Random &random);
 
   bool explodesOnDeath() const override { return true; }
 
-  std::list<std::shared_ptr<GraphObj>> explode() override;
+  void explode(std::vector<std::shared_ptr<GraphObj>> *ejecta, UpdateContext *context) override;
 
-  void knockAsteriod(float minLinearSpeed, float maxLinearSpeed);
+  CollisionOutline getCollisionOutline() const override;
+
+  void knockAsteriod(float minLinearSpeed, float maxLinearSpeed, Random &random);
 
   void disintegrate() override
   {
@@ -38,10 +40,14 @@ public:
     kill();
   }
 
+protected:
+  void placeShapes(WorldGeometry *geometry, sf::Vector2f center, AngleFactors angleFact) const override;
+
 private:
   bool mChildrenAllowed = true;
-  float mRemainingLifeSeconds = 0;
   float mMinChildSize = 0;
+  int mShapeIndex = 0; // Into AsteroidShapeLibrary
+  float mScale = 0;    // The outline's size in the game
 };
 
 #endif
\ No newline at end of file
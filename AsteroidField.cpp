@@ -0,0 +1,53 @@
+/**
+ * @file AsteroidField.cpp
+ *
+ * Implements a game box filled with a field of drifting asteroids.
+ */
+
+#include "AsteroidField.h"
+#include "Asteroid.h"
+
+void AsteroidField::populateField(FieldConfig config, sf::Vector2u spaceSize)
+{
+  Random &random = getRandom();
+  int numAsteroids = random.randInt(config.minAsteroids, config.maxAsteroids);
+
+  for (int index = 0; index < numAsteroids; index++)
+  {
+    Asteroid::Config asteroidConfig = {};
+    asteroidConfig.maxSize = config.maxAsteroidSize;
+    asteroidConfig.minSize = config.minAsteroidSize;
+    asteroidConfig.minChildSize = config.minAsteroidSize;
+    float colorRatio = random.randFloat(0, 1);
+    asteroidConfig.color = sf::Color(
+      (int)(config.minColor.r + (config.maxColor.r - config.minColor.r) * colorRatio),
+      (int)(config.minColor.g + (config.maxColor.g - config.minColor.g) * colorRatio),
+      (int)(config.minColor.b + (config.maxColor.b - config.minColor.b) * colorRatio));
+    auto asteroid = std::make_shared<Asteroid>(asteroidConfig, random);
+    sf::Vector2f asteroidPos(random.randFloat(0, (float)spaceSize.x), random.randFloat(0, (float)spaceSize.y));
+    asteroid->setPosition(asteroidPos);
+    GraphObj::KnockConfig knockConfig;
+    knockConfig.maxLinearSpeed = config.maxLinearSpeed;
+    knockConfig.maxRadialSpeed = config.maxRadialSpeed;
+    asteroid->knockRand(knockConfig, random);
+    asteroid->setTeam(config.teamIndex);
+    add(asteroid);
+  }
+
+  mTeamIndex = config.teamIndex;
+}
+
+void AsteroidField::disintegrateAround(sf::Vector2f center, float radius, sf::Vector2u spaceSize)
+{
+  mNearby.clear();
+  queryRadius(center, radius, spaceSize, &mNearby, mTeamIndex);
+  for (auto obj : mNearby)
+  {
+    obj->disintegrate();
+  }
+}
+
+int AsteroidField::getAsteroidTeamCount()
+{
+  return (int)getTeamCount(mTeamIndex);
+}
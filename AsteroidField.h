@@ -0,0 +1,43 @@
+/**
+ * @file AsteroidField.h
+ *
+ * Defines a game box filled with a field of drifting asteroids.
+ */
+
+#ifndef ASTEROID_FIELD_H_2026_10_17
+#define ASTEROID_FIELD_H_2026_10_17
+
+#include "GameBox.h"
+
+static const sf::Color kDarkBrown(128, 64, 0);
+static const int kAsteroidTeamIndex = 2;
+
+class AsteroidField : public GameBox
+{
+public:
+  struct FieldConfig
+  {
+    int minAsteroids = 0;
+    int maxAsteroids = 0;
+    float minAsteroidSize = 0;
+    float maxAsteroidSize = 0;
+    float maxLinearSpeed = 0;
+    float maxRadialSpeed = 0;
+    sf::Color minColor = kDarkBrown;
+    sf::Color maxColor = kDarkBrown;
+    int teamIndex = kAsteroidTeamIndex;
+  };
+
+  AsteroidField() : GameBox() {}
+
+  void populateField(FieldConfig config, sf::Vector2u spaceSize);
+  void disintegrateAround(sf::Vector2f center, float radius, sf::Vector2u spaceSize);
+
+  int getAsteroidTeamCount();
+
+protected:
+  int mTeamIndex = 0;
+  std::vector<GraphObj *> mNearby; // Reused by disintegrateAround
+};
+
+#endif
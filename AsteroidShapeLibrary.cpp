@@ -0,0 +1,52 @@
+/**
+ * @file AsteroidShapeLibrary.cpp
+ *
+ * Implements the shared library of asteroid outlines.
+ */
+
+#include "AsteroidShapeLibrary.h"
+#include "PolygonCollision.h"
+
+#include <algorithm>
+#include <math.h>
+
+static const float kMinSideRatio = 0.80F;
+static const float kMaxSideRatio = 1.30F;
+static const int kMinAsteroidPoints = 6;
+static const int kMaxAsteroidPoints = 12;
+static const float kMinAngleRatio = -0.33F;
+static const float kMaxAngleRatio = 0.33F;
+
+static const uint64_t kLibrarySeed = 0xA57E801DULL;
+
+AsteroidShapeLibrary::AsteroidShapeLibrary(int shapeCount, uint64_t seed)
+{
+  Random random(seed);
+  for (int shape = 0; shape < shapeCount; shape++)
+  {
+    // Points spaced roughly evenly round a circle, each pushed in or out
+    // and along a little
+    OutlineRange range;
+    range.first = (int)mPoints.size();
+    range.count = random.randInt(kMinAsteroidPoints, kMaxAsteroidPoints);
+    range.maxRadius = 0;
+    double nextAngle = 0;
+    double deltaAngle = 2 * PI / range.count;
+    for (int i = 0; i < range.count; i++)
+    {
+      double angle = nextAngle + random.randFloat(kMinAngleRatio, kMaxAngleRatio) * deltaAngle;
+      double len = random.randFloat(kMinSideRatio, kMaxSideRatio);
+      mPoints.push_back(sf::Vector2f((float)(cos(angle) * len), (float)(sin(angle) * len)));
+      range.maxRadius = std::max(range.maxRadius, (float)len);
+      nextAngle += deltaAngle;
+    }
+    range.innerRadius = PolygonCollision::getInnerRadius(&mPoints[range.first], range.count);
+    mOutlines.push_back(range);
+  }
+}
+
+const AsteroidShapeLibrary &AsteroidShapeLibrary::get()
+{
+  static const AsteroidShapeLibrary library(kDefaultShapeCount, kLibrarySeed);
+  return library;
+}
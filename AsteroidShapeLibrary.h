@@ -0,0 +1,61 @@
+/**
+ * @file AsteroidShapeLibrary.h
+ *
+ * Defines a library of random asteroid outlines, built once and shared by
+ * every asteroid.  An asteroid only keeps the index of its outline and
+ * the scale to draw it at, so making one is a lookup rather than a run of
+ * random numbers, sines and cosines.
+ *
+ * Each outline is a ring of points around the origin, at a nominal
+ * radius of one.
+ */
+
+#ifndef ASTEROID_SHAPE_LIBRARY_H_2026_10_17
+#define ASTEROID_SHAPE_LIBRARY_H_2026_10_17
+
+#include <vector>
+#include "GraphObj.h"
+
+class AsteroidShapeLibrary
+{
+public:
+  static const int kDefaultShapeCount = 64;
+
+  struct Outline
+  {
+    const sf::Vector2f *points;
+    int pointCount;
+    float maxRadius;   // The farthest any point is from the origin
+    float innerRadius; // The nearest any edge comes to the origin
+  };
+
+  // Builds shapeCount outlines from the given seed.  The same seed always
+  // gives the same outlines.
+  AsteroidShapeLibrary(int shapeCount, uint64_t seed);
+
+  // The library all asteroids draw from, built on first use.
+  static const AsteroidShapeLibrary &get();
+
+  int getShapeCount() const { return (int)mOutlines.size(); }
+
+  Outline getOutline(int index) const
+  {
+    const OutlineRange &range = mOutlines[index];
+    Outline outline = { &mPoints[range.first], range.count, range.maxRadius, range.innerRadius };
+    return outline;
+  }
+
+private:
+  struct OutlineRange
+  {
+    int first;
+    int count;
+    float maxRadius;
+    float innerRadius;
+  };
+
+  std::vector<sf::Vector2f> mPoints;
+  std::vector<OutlineRange> mOutlines;
+};
+
+#endif
@@ -17,10 +17,15 @@ Bolt::Bolt(const Config &config) : GraphObj()
   spike[2].color = config.color;
   mModelShapes.push_back(spike);
   mCollisionRadius = config.size;
+
+  mType = ObjectType::Bolt;
+  // Bolts travel many times their own length each frame
+  mIsFast = true;
+  mIsPassive = true;
 }
 
 void Bolt::onOutOfBounds(UpdateContext *context)
 {
-  mIsAlive = false;
+  kill();
 }
 
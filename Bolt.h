@@ -9,7 +9,7 @@
 
 #include "GraphObj.h"
 
-class Bolt : public GraphObj
+class Bolt final : public GraphObj
 {
 public:
 
@@ -0,0 +1,63 @@
+/**
+ * @file BroadphaseAgreementTest.cpp
+ *
+ * Checks that every collision mode finds the same collisions: the
+ * spatial hash and the sweep and prune must feed the narrowphase every
+ * pair the brute force search would hit, with the circle narrowphase
+ * and with the polygon one.
+ */
+
+#include <stdio.h>
+
+#include "TestScene.h"
+
+static const int kTicks = 200;
+static const int kThreads = 4;
+
+static int gFailures = 0;
+
+static void check(bool passed, const char *what)
+{
+  if (!passed)
+  {
+    printf("FAILED: %s\n", what);
+    gFailures++;
+  }
+}
+
+static TestSceneResult runIn(GameBox::CollisionMode mode, bool polygonCollisions)
+{
+  AsteroidField field;
+  field.setUpdateThreads(kThreads);
+  field.setCollisionMode(mode);
+  field.setPolygonCollisions(polygonCollisions);
+  return runTestScene(&field, kTicks);
+}
+
+static void checkAgreement(bool polygonCollisions)
+{
+  const char *narrowphase = polygonCollisions ? "polygon" : "circle";
+  TestSceneResult bruteForce = runIn(GameBox::CollisionMode::BruteForce, polygonCollisions);
+  GameBox::CollisionMode modes[] = { GameBox::CollisionMode::SpatialHash, GameBox::CollisionMode::SweepAndPrune };
+  const char *modeNames[] = { "spatial hash", "sweep and prune" };
+  for (int index = 0; index < 2; index++)
+  {
+    TestSceneResult result = runIn(modes[index], polygonCollisions);
+    char what[128];
+    snprintf(what, sizeof(what), "the %s finds the brute force's collisions, %s narrowphase",
+             modeNames[index], narrowphase);
+    check(result.collisions == bruteForce.collisions, what);
+    snprintf(what, sizeof(what), "the %s leaves the brute force's objects, %s narrowphase",
+             modeNames[index], narrowphase);
+    check(result.objects == bruteForce.objects, what);
+  }
+}
+
+int main()
+{
+  checkAgreement(false);
+  checkAgreement(true);
+
+  printf("%s\n", gFailures == 0 ? "passed" : "failed");
+  return gFailures == 0 ? 0 : 1;
+}
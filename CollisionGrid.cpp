@@ -0,0 +1,244 @@
+/**
+ * @file CollisionGrid.cpp
+ *
+ * Implements the uniform grid collision broadphase.
+ */
+
+#include "CollisionGrid.h"
+#include "CollisionKernel.h"
+
+#include <algorithm>
+#include <math.h>
+
+// Keeps the cell count in proportion to the object count, so a field
+// of tiny objects doesn't spend its time clearing empty cells.
+static const int kMaxCellsPerObject = 4;
+static const int kMinMaxCells = 64;
+
+static int wrapIndex(int index, int count)
+{
+  index %= count;
+  if (index < 0)
+  {
+    index += count;
+  }
+  return index;
+}
+
+int CollisionGrid::columnOf(float x) const
+{
+  return wrapIndex((int)floor(x / mCellWidth), mColumns);
+}
+
+int CollisionGrid::rowOf(float y) const
+{
+  return wrapIndex((int)floor(y / mCellHeight), mRows);
+}
+
+void CollisionGrid::build(const std::vector<CollisionEnvelope> &envelopes, const std::vector<int> &teams,
+                          sf::Vector2u spaceLimits)
+{
+  float spaceWidth = (float)std::max(spaceLimits.x, 1U);
+  float spaceHeight = (float)std::max(spaceLimits.y, 1U);
+
+  float maxRadius = 0;
+  for (auto &envelope : envelopes)
+  {
+    maxRadius = std::max(maxRadius, envelope.radius);
+  }
+  mMaxRadius = maxRadius;
+
+  int maxCells = std::max(kMinMaxCells, (int)envelopes.size() * kMaxCellsPerObject);
+  float cellSize = std::max(2 * maxRadius, sqrt(spaceWidth * spaceHeight / maxCells));
+
+  // Round down so the cells tile the space exactly, which keeps the
+  // wrapped neighbors correct at the far edges.
+  mColumns = std::max(1, (int)(spaceWidth / cellSize));
+  mRows = std::max(1, (int)(spaceHeight / cellSize));
+  mCellWidth = spaceWidth / mColumns;
+  mCellHeight = spaceHeight / mRows;
+
+  // Counting sort of the envelopes into their cells
+  int cellCount = mColumns * mRows;
+  mCellStart.assign(cellCount + 1, 0);
+  mObjectCell.resize(envelopes.size());
+  for (size_t index = 0; index < envelopes.size(); index++)
+  {
+    int cell = rowOf(envelopes[index].center.y) * mColumns + columnOf(envelopes[index].center.x);
+    mObjectCell[index] = cell;
+    mCellStart[cell + 1]++;
+  }
+  for (int cell = 0; cell < cellCount; cell++)
+  {
+    mCellStart[cell + 1] += mCellStart[cell];
+  }
+  mCellObjects.resize(envelopes.size());
+  mObjectSlot.resize(envelopes.size());
+  mPackedX.resize(envelopes.size());
+  mPackedY.resize(envelopes.size());
+  mPackedRadius.resize(envelopes.size());
+  mPackedTeam.resize(envelopes.size());
+  mCellFill.assign(mCellStart.begin(), mCellStart.end() - 1);
+  for (size_t index = 0; index < envelopes.size(); index++)
+  {
+    int slot = mCellFill[mObjectCell[index]]++;
+    mCellObjects[slot] = (int)index;
+    mObjectSlot[index] = slot;
+    mPackedX[slot] = envelopes[index].center.x;
+    mPackedY[slot] = envelopes[index].center.y;
+    mPackedRadius[slot] = envelopes[index].radius;
+    mPackedTeam[slot] = teams[index];
+  }
+}
+
+int CollisionGrid::neighborCells(int column, int row, int cells[9]) const
+{
+  int columns[3];
+  int columnCount = 0;
+  for (int delta = -1; delta <= 1; delta++)
+  {
+    int next = wrapIndex(column + delta, mColumns);
+    if (std::find(columns, columns + columnCount, next) == columns + columnCount)
+    {
+      columns[columnCount++] = next;
+    }
+  }
+
+  int rows[3];
+  int rowCount = 0;
+  for (int delta = -1; delta <= 1; delta++)
+  {
+    int next = wrapIndex(row + delta, mRows);
+    if (std::find(rows, rows + rowCount, next) == rows + rowCount)
+    {
+      rows[rowCount++] = next;
+    }
+  }
+
+  int count = 0;
+  for (int r = 0; r < rowCount; r++)
+  {
+    for (int c = 0; c < columnCount; c++)
+    {
+      cells[count++] = rows[r] * mColumns + columns[c];
+    }
+  }
+  return count;
+}
+
+void CollisionGrid::findPairs(std::vector<std::pair<int, int>> *pairs) const
+{
+  if (pairs == nullptr)
+  {
+    return;
+  }
+
+  for (size_t index = 0; index < mObjectCell.size(); index++)
+  {
+    int cell = mObjectCell[index];
+    int cells[9];
+    int cellCount = neighborCells(cell % mColumns, cell / mColumns, cells);
+    for (int n = 0; n < cellCount; n++)
+    {
+      for (int slot = mCellStart[cells[n]]; slot < mCellStart[cells[n] + 1]; slot++)
+      {
+        int other = mCellObjects[slot];
+        if (other > (int)index)
+        {
+          pairs->push_back(std::make_pair((int)index, other));
+        }
+      }
+    }
+  }
+}
+
+void CollisionGrid::findOverlaps(std::vector<std::pair<int, int>> *pairs, sf::Vector2f wrapSpan) const
+{
+  if (pairs == nullptr)
+  {
+    return;
+  }
+
+  CollisionKernel::CircleSet packed = { mPackedX.data(), mPackedY.data(), mPackedRadius.data(), mPackedTeam.data() };
+  for (size_t index = 0; index < mObjectCell.size(); index++)
+  {
+    int slot = mObjectSlot[index];
+    CollisionEnvelope query(sf::Vector2f(mPackedX[slot], mPackedY[slot]), mPackedRadius[slot]);
+    int team = mPackedTeam[slot];
+
+    int cell = mObjectCell[index];
+    int cells[9];
+    int cellCount = neighborCells(cell % mColumns, cell / mColumns, cells);
+    for (int n = 0; n < cellCount; n++)
+    {
+      int end = mCellStart[cells[n] + 1];
+      for (int first = mCellStart[cells[n]]; first < end; first += (int)CollisionKernel::kMaxBlockSize)
+      {
+        size_t count = std::min((size_t)(end - first), CollisionKernel::kMaxBlockSize);
+        uint32_t mask = CollisionKernel::overlapMask(query, team, packed, first, count, wrapSpan);
+        for (int bit = 0; mask != 0; bit++, mask >>= 1)
+        {
+          int other = mCellObjects[first + bit];
+          if ((mask & 1) && other > (int)index)
+          {
+            pairs->push_back(std::make_pair((int)index, other));
+          }
+        }
+      }
+    }
+  }
+}
+
+int CollisionGrid::spanIndices(int index, int span, int count, std::vector<int> *indices)
+{
+  indices->clear();
+  if (2 * span + 1 >= count)
+  {
+    for (int next = 0; next < count; next++)
+    {
+      indices->push_back(next);
+    }
+  }
+  else
+  {
+    for (int delta = -span; delta <= span; delta++)
+    {
+      indices->push_back(wrapIndex(index + delta, count));
+    }
+  }
+  return (int)indices->size();
+}
+
+void CollisionGrid::findNear(const CollisionEnvelope &area, int team, sf::Vector2f wrapSpan, std::vector<int> *indices) const
+{
+  if (indices == nullptr || mObjectCell.empty())
+  {
+    return;
+  }
+
+  // Any envelope touching the area has its center within this reach
+  CollisionKernel::CircleSet packed = { mPackedX.data(), mPackedY.data(), mPackedRadius.data(), mPackedTeam.data() };
+  float reach = area.radius + mMaxRadius;
+  int columnCount = spanIndices(columnOf(area.center.x), (int)ceil(reach / mCellWidth), mColumns, &mNearColumns);
+  int rowCount = spanIndices(rowOf(area.center.y), (int)ceil(reach / mCellHeight), mRows, &mNearRows);
+  for (int r = 0; r < rowCount; r++)
+  {
+    for (int c = 0; c < columnCount; c++)
+    {
+      int cell = mNearRows[r] * mColumns + mNearColumns[c];
+      int end = mCellStart[cell + 1];
+      for (int first = mCellStart[cell]; first < end; first += (int)CollisionKernel::kMaxBlockSize)
+      {
+        size_t count = std::min((size_t)(end - first), CollisionKernel::kMaxBlockSize);
+        uint32_t mask = CollisionKernel::overlapMask(area, team, packed, first, count, wrapSpan);
+        for (int bit = 0; mask != 0; bit++, mask >>= 1)
+        {
+          if (mask & 1)
+          {
+            indices->push_back(mCellObjects[first + bit]);
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,79 @@
+/**
+ * @file CollisionGrid.h
+ *
+ * Defines a uniform grid used as a collision broadphase.  Objects are
+ * bucketed by the cell holding their center, and only objects in
+ * neighboring cells are handed on as candidate pairs.  The grid wraps
+ * around the space limits the same way objects do when they leave the
+ * game bounds.
+ */
+
+#ifndef COLLISION_GRID_H_2026_10_17
+#define COLLISION_GRID_H_2026_10_17
+
+#include <vector>
+#include <utility>
+#include "GraphObj.h"
+
+class CollisionGrid
+{
+public:
+  CollisionGrid() {}
+
+  // Rebuilds the grid for the given envelopes and their teams.  The
+  // cell size is at least the largest envelope diameter, so any two
+  // overlapping envelopes are at most one cell apart.
+  void build(const std::vector<CollisionEnvelope> &envelopes, const std::vector<int> &teams,
+             sf::Vector2u spaceLimits);
+
+  // Appends every candidate pair (first < second) of envelope indices
+  // that share a cell neighborhood.
+  void findPairs(std::vector<std::pair<int, int>> *pairs) const;
+
+  // Appends the pairs (first < second) in neighboring cells whose
+  // envelopes actually overlap and whose teams differ, testing each
+  // cell as a block with the collision kernel.
+  void findOverlaps(std::vector<std::pair<int, int>> *pairs, sf::Vector2f wrapSpan) const;
+
+  // Appends the indices of the envelopes that overlap the area and
+  // aren't on the given team, visiting only the cells within reach of it
+  // and testing each cell as a block with the collision kernel.
+  void findNear(const CollisionEnvelope &area, int team, sf::Vector2f wrapSpan, std::vector<int> *indices) const;
+
+private:
+  int columnOf(float x) const;
+  int rowOf(float y) const;
+
+  // Gathers the distinct cell indices around the given cell, which
+  // can overlap when the grid is less than three cells wide or high.
+  int neighborCells(int column, int row, int cells[9]) const;
+
+  // Gathers the distinct indices within span of the given one, wrapping
+  // round count.  Returns how many there are.
+  static int spanIndices(int index, int span, int count, std::vector<int> *indices);
+
+  float mCellWidth = 1;
+  float mCellHeight = 1;
+  int mColumns = 1;
+  int mRows = 1;
+  float mMaxRadius = 0;
+
+  std::vector<int> mObjectCell;  // Cell index of each envelope
+  std::vector<int> mCellStart;   // Offset into mCellObjects for each cell, plus an end marker
+  std::vector<int> mCellObjects; // Envelope indices grouped by cell
+  std::vector<int> mObjectSlot;  // Where each envelope is in mCellObjects
+  std::vector<int> mCellFill;    // Scratch for build: the next free slot in each cell
+
+  // The envelopes and teams, in the same order as mCellObjects, so a
+  // cell's contents can be tested as one block.
+  std::vector<float> mPackedX;
+  std::vector<float> mPackedY;
+  std::vector<float> mPackedRadius;
+  std::vector<int> mPackedTeam;
+
+  // Scratch space for findNear
+  mutable std::vector<int> mNearColumns;
+  mutable std::vector<int> mNearRows;
+};
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file CollisionKernel.cpp
+ *
+ * Implements the block circle overlap test.
+ */
+
+#include "CollisionKernel.h"
+
+#if defined(__AVX2__)
+#define COLLISION_KERNEL_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLLISION_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(COLLISION_KERNEL_AVX2)
+
+static const size_t kLanes = 8;
+
+// Moves each delta over half a span back by a span, the short way round.
+static inline __m256 wrapLanes(__m256 delta, __m256 span, __m256 halfSpan, __m256 negHalfSpan)
+{
+  __m256 above = _mm256_cmp_ps(delta, halfSpan, _CMP_GT_OQ);
+  __m256 below = _mm256_cmp_ps(delta, negHalfSpan, _CMP_LT_OQ);
+  delta = _mm256_sub_ps(delta, _mm256_and_ps(above, span));
+  return _mm256_add_ps(delta, _mm256_and_ps(below, span));
+}
+
+static size_t overlapLanes(const CollisionEnvelope &query, int queryTeam,
+                           const CollisionKernel::CircleSet &set, size_t first, size_t count,
+                           sf::Vector2f wrapSpan, uint32_t *mask)
+{
+  __m256 queryX = _mm256_set1_ps(query.center.x);
+  __m256 queryY = _mm256_set1_ps(query.center.y);
+  __m256 queryRadius = _mm256_set1_ps(query.radius);
+  __m256i team = _mm256_set1_epi32(queryTeam);
+  bool wrap = wrapSpan.x > 0 || wrapSpan.y > 0;
+  __m256 spanX = _mm256_set1_ps(wrapSpan.x);
+  __m256 spanY = _mm256_set1_ps(wrapSpan.y);
+  __m256 halfX = _mm256_set1_ps(wrapSpan.x / 2);
+  __m256 halfY = _mm256_set1_ps(wrapSpan.y / 2);
+  __m256 negHalfX = _mm256_set1_ps(-wrapSpan.x / 2);
+  __m256 negHalfY = _mm256_set1_ps(-wrapSpan.y / 2);
+
+  size_t done = 0;
+  for (; done + kLanes <= count; done += kLanes)
+  {
+    size_t index = first + done;
+    __m256 deltaX = _mm256_sub_ps(queryX, _mm256_loadu_ps(set.centerX + index));
+    __m256 deltaY = _mm256_sub_ps(queryY, _mm256_loadu_ps(set.centerY + index));
+    if (wrap)
+    {
+      deltaX = wrapLanes(deltaX, spanX, halfX, negHalfX);
+      deltaY = wrapLanes(deltaY, spanY, halfY, negHalfY);
+    }
+    __m256 minDistance = _mm256_add_ps(queryRadius, _mm256_loadu_ps(set.radius + index));
+    __m256 distanceSq = _mm256_add_ps(_mm256_mul_ps(deltaX, deltaX), _mm256_mul_ps(deltaY, deltaY));
+    __m256 hit = _mm256_cmp_ps(distanceSq, _mm256_mul_ps(minDistance, minDistance), _CMP_LT_OQ);
+    __m256i sameTeam = _mm256_cmpeq_epi32(team, _mm256_loadu_si256((const __m256i *)(set.team + index)));
+    hit = _mm256_andnot_ps(_mm256_castsi256_ps(sameTeam), hit);
+    *mask |= (uint32_t)_mm256_movemask_ps(hit) << done;
+  }
+  return done;
+}
+
+#elif defined(COLLISION_KERNEL_SSE2)
+
+static const size_t kLanes = 4;
+
+// Moves each delta over half a span back by a span, the short way round.
+static inline __m128 wrapLanes(__m128 delta, __m128 span, __m128 halfSpan, __m128 negHalfSpan)
+{
+  __m128 above = _mm_cmpgt_ps(delta, halfSpan);
+  __m128 below = _mm_cmplt_ps(delta, negHalfSpan);
+  delta = _mm_sub_ps(delta, _mm_and_ps(above, span));
+  return _mm_add_ps(delta, _mm_and_ps(below, span));
+}
+
+static size_t overlapLanes(const CollisionEnvelope &query, int queryTeam,
+                           const CollisionKernel::CircleSet &set, size_t first, size_t count,
+                           sf::Vector2f wrapSpan, uint32_t *mask)
+{
+  __m128 queryX = _mm_set1_ps(query.center.x);
+  __m128 queryY = _mm_set1_ps(query.center.y);
+  __m128 queryRadius = _mm_set1_ps(query.radius);
+  __m128i team = _mm_set1_epi32(queryTeam);
+  bool wrap = wrapSpan.x > 0 || wrapSpan.y > 0;
+  __m128 spanX = _mm_set1_ps(wrapSpan.x);
+  __m128 spanY = _mm_set1_ps(wrapSpan.y);
+  __m128 halfX = _mm_set1_ps(wrapSpan.x / 2);
+  __m128 halfY = _mm_set1_ps(wrapSpan.y / 2);
+  __m128 negHalfX = _mm_set1_ps(-wrapSpan.x / 2);
+  __m128 negHalfY = _mm_set1_ps(-wrapSpan.y / 2);
+
+  size_t done = 0;
+  for (; done + kLanes <= count; done += kLanes)
+  {
+    size_t index = first + done;
+    __m128 deltaX = _mm_sub_ps(queryX, _mm_loadu_ps(set.centerX + index));
+    __m128 deltaY = _mm_sub_ps(queryY, _mm_loadu_ps(set.centerY + index));
+    if (wrap)
+    {
+      deltaX = wrapLanes(deltaX, spanX, halfX, negHalfX);
+      deltaY = wrapLanes(deltaY, spanY, halfY, negHalfY);
+    }
+    __m128 minDistance = _mm_add_ps(queryRadius, _mm_loadu_ps(set.radius + index));
+    __m128 distanceSq = _mm_add_ps(_mm_mul_ps(deltaX, deltaX), _mm_mul_ps(deltaY, deltaY));
+    __m128 hit = _mm_cmplt_ps(distanceSq, _mm_mul_ps(minDistance, minDistance));
+    __m128i sameTeam = _mm_cmpeq_epi32(team, _mm_loadu_si128((const __m128i *)(set.team + index)));
+    hit = _mm_andnot_ps(_mm_castsi128_ps(sameTeam), hit);
+    *mask |= (uint32_t)_mm_movemask_ps(hit) << done;
+  }
+  return done;
+}
+
+#else
+
+static size_t overlapLanes(const CollisionEnvelope &, int, const CollisionKernel::CircleSet &,
+                           size_t, size_t, sf::Vector2f, uint32_t *)
+{
+  return 0;
+}
+
+#endif
+
+uint32_t CollisionKernel::overlapMask(const CollisionEnvelope &query, int queryTeam,
+                                      const CircleSet &set, size_t first, size_t count,
+                                      sf::Vector2f wrapSpan)
+{
+  uint32_t mask = 0;
+  size_t done = overlapLanes(query, queryTeam, set, first, count, wrapSpan, &mask);
+
+  // Whatever doesn't fill a whole vector
+  for (; done < count; done++)
+  {
+    size_t index = first + done;
+    CollisionEnvelope other(sf::Vector2f(set.centerX[index], set.centerY[index]), set.radius[index]);
+    if (overlaps(query, queryTeam, other, set.team[index], wrapSpan))
+    {
+      mask |= 1U << done;
+    }
+  }
+  return mask;
+}
+
+const char *CollisionKernel::getInstructionSet()
+{
+#if defined(COLLISION_KERNEL_AVX2)
+  return "AVX2";
+#elif defined(COLLISION_KERNEL_SSE2)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,89 @@
+/**
+ * @file CollisionKernel.h
+ *
+ * Defines the circle overlap test used by the collision narrowphase, in
+ * a form that tests one circle against a packed block of others at once.
+ * The block test uses AVX2 or SSE2 where the compiler targets them, and
+ * plain code otherwise; every version gives the same answers.
+ *
+ * Teams are part of the test: circles on the same team never overlap.
+ * A wrap span of zero tests straight distances; a positive span measures
+ * along that axis the short way round, as in WRAP_COLLISION builds.
+ */
+
+#ifndef COLLISION_KERNEL_H_2026_10_17
+#define COLLISION_KERNEL_H_2026_10_17
+
+#include <stddef.h>
+#include <stdint.h>
+#include "GraphObj.h"
+
+namespace CollisionKernel
+{
+  // The most circles one block test can cover; one bit each in the mask.
+  static const size_t kMaxBlockSize = 32;
+
+  // Circles packed one property per array.
+  struct CircleSet
+  {
+    const float *centerX;
+    const float *centerY;
+    const float *radius;
+    const int *team;
+  };
+
+  // The wrap spans for a collision pass: the space limits when
+  // collisions wrap, otherwise zero.
+  inline sf::Vector2f getWrapSpan(sf::Vector2u spaceLimits)
+  {
+#ifdef WRAP_COLLISION
+    return sf::Vector2f((float)spaceLimits.x, (float)spaceLimits.y);
+#else
+    (void)spaceLimits;
+    return sf::Vector2f();
+#endif
+  }
+
+  inline float wrapDelta(float delta, float span)
+  {
+    if (span > 0)
+    {
+      if (delta > span / 2)
+      {
+        return delta - span;
+      }
+      if (delta < -span / 2)
+      {
+        return delta + span;
+      }
+    }
+    return delta;
+  }
+
+  // Tests a single pair, exactly as the block test would.
+  inline bool overlaps(const CollisionEnvelope &first, int firstTeam,
+                       const CollisionEnvelope &second, int secondTeam,
+                       sf::Vector2f wrapSpan)
+  {
+    if (firstTeam == secondTeam)
+    {
+      return false;
+    }
+    float deltaX = wrapDelta(first.center.x - second.center.x, wrapSpan.x);
+    float deltaY = wrapDelta(first.center.y - second.center.y, wrapSpan.y);
+    float minDistance = first.radius + second.radius;
+    return deltaX * deltaX + deltaY * deltaY < minDistance * minDistance;
+  }
+
+  // Tests the query against circles [first, first + count) of the set,
+  // where count is at most kMaxBlockSize.  Bit k of the result is set
+  // when circle first + k overlaps the query.
+  uint32_t overlapMask(const CollisionEnvelope &query, int queryTeam,
+                       const CircleSet &set, size_t first, size_t count,
+                       sf::Vector2f wrapSpan);
+
+  // The instruction set the block test was built for.
+  const char *getInstructionSet();
+}
+
+#endif
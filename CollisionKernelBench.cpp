@@ -0,0 +1,160 @@
+/**
+ * @file CollisionKernelBench.cpp
+ *
+ * Times the block collision kernel against the per-pair collidesWith
+ * calls it replaced, on a fixed random field of asteroids.  Both are run
+ * two ways: every object against every other, and over the pairs the
+ * collision grid hands on.  The hit counts are printed too, since the
+ * two paths must agree.
+ *
+ * Usage: CollisionKernelBench [objects] [repeats]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "Asteroid.h"
+#include "CollisionGrid.h"
+#include "CollisionKernel.h"
+
+static const int kDefaultObjects = 4000;
+static const int kDefaultRepeats = 5;
+static const unsigned int kWidth = 1920;
+static const unsigned int kHeight = 1080;
+static const int kTeamCount = 4;
+static const uint64_t kSeed = 1;
+
+// Runs the test the given number of times, returning the fastest time
+// in milliseconds and the hit count.
+template<typename Test>
+static double timeBest(int repeats, Test test, long long *hits)
+{
+  double best = 0;
+  for (int repeat = 0; repeat < repeats; repeat++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    *hits = test();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    if (repeat == 0 || elapsed.count() < best)
+    {
+      best = elapsed.count();
+    }
+  }
+  return best;
+}
+
+static void report(const char *name, double perPairTime, long long perPairHits,
+                   double kernelTime, long long kernelHits)
+{
+  printf("%-10s per pair %9.3f ms (%lld hits)  kernel %9.3f ms (%lld hits)  speedup %.2fx%s\n",
+         name, perPairTime, perPairHits, kernelTime, kernelHits,
+         kernelTime > 0 ? perPairTime / kernelTime : 0.0,
+         perPairHits == kernelHits ? "" : "  MISMATCH");
+}
+
+int main(int argc, char *argv[])
+{
+  int objectCount = argc > 1 ? atoi(argv[1]) : kDefaultObjects;
+  int repeats = argc > 2 ? atoi(argv[2]) : kDefaultRepeats;
+  sf::Vector2u spaceLimits(kWidth, kHeight);
+
+  Random random(kSeed);
+  std::vector<std::shared_ptr<GraphObj>> objects;
+  std::vector<CollisionEnvelope> envelopes;
+  std::vector<int> teams;
+  for (int index = 0; index < objectCount; index++)
+  {
+    Asteroid::Config config;
+    config.minSize = 5;
+    config.maxSize = 30;
+    config.color = sf::Color::White;
+    auto asteroid = std::make_shared<Asteroid>(config, random);
+    asteroid->setPosition(sf::Vector2f(random.randFloat(0, (float)kWidth), random.randFloat(0, (float)kHeight)));
+    asteroid->setTeam(random.randInt(0, kTeamCount - 1));
+    objects.push_back(asteroid);
+    envelopes.push_back(asteroid->getSweptEnvelope());
+    teams.push_back(asteroid->getTeam());
+  }
+
+  GraphObj::UpdateContext context;
+  context.spaceLimits = spaceLimits;
+  sf::Vector2f wrapSpan = CollisionKernel::getWrapSpan(spaceLimits);
+
+  std::vector<float> centerX;
+  std::vector<float> centerY;
+  std::vector<float> radius;
+  for (auto &envelope : envelopes)
+  {
+    centerX.push_back(envelope.center.x);
+    centerY.push_back(envelope.center.y);
+    radius.push_back(envelope.radius);
+  }
+  CollisionKernel::CircleSet packed = { centerX.data(), centerY.data(), radius.data(), teams.data() };
+
+  printf("%d objects, kernel built for %s\n", objectCount, CollisionKernel::getInstructionSet());
+
+  // Every object against every later one
+  long long perPairHits = 0;
+  double perPairTime = timeBest(repeats, [&]()
+  {
+    long long hits = 0;
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+      for (size_t j = i + 1; j < objects.size(); j++)
+      {
+        hits += objects[i]->collidesWith(*objects[j], &context) ? 1 : 0;
+      }
+    }
+    return hits;
+  }, &perPairHits);
+
+  long long kernelHits = 0;
+  double kernelTime = timeBest(repeats, [&]()
+  {
+    long long hits = 0;
+    for (size_t i = 0; i < envelopes.size(); i++)
+    {
+      for (size_t first = i + 1; first < envelopes.size(); first += CollisionKernel::kMaxBlockSize)
+      {
+        size_t count = std::min(envelopes.size() - first, CollisionKernel::kMaxBlockSize);
+        uint32_t mask = CollisionKernel::overlapMask(envelopes[i], teams[i], packed, first, count, wrapSpan);
+        for (; mask != 0; mask &= mask - 1)
+        {
+          hits++;
+        }
+      }
+    }
+    return hits;
+  }, &kernelHits);
+  report("all pairs", perPairTime, perPairHits, kernelTime, kernelHits);
+
+  // Only the grid's neighbors
+  CollisionGrid grid;
+  grid.build(envelopes, teams, spaceLimits);
+  std::vector<std::pair<int, int>> pairs;
+  perPairTime = timeBest(repeats, [&]()
+  {
+    pairs.clear();
+    grid.findPairs(&pairs);
+    long long hits = 0;
+    for (auto &pair : pairs)
+    {
+      hits += objects[pair.first]->collidesWith(*objects[pair.second], &context) ? 1 : 0;
+    }
+    return hits;
+  }, &perPairHits);
+
+  kernelTime = timeBest(repeats, [&]()
+  {
+    pairs.clear();
+    grid.findOverlaps(&pairs, wrapSpan);
+    return (long long)pairs.size();
+  }, &kernelHits);
+  report("grid", perPairTime, perPairHits, kernelTime, kernelHits);
+
+  return perPairHits == kernelHits ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file CollisionMatrix.cpp
+ *
+ * Implements the rules for which objects may collide.
+ */
+
+#include "CollisionMatrix.h"
+
+const int CollisionMatrix::kMaxTeams;
+
+CollisionMatrix::CollisionMatrix()
+{
+  for (auto &mask : mTeamMasks)
+  {
+    mask = ~(uint64_t)0;
+  }
+  for (auto &mask : mTypeMasks)
+  {
+    mask = (1U << kObjectTypeCount) - 1;
+  }
+}
+
+void CollisionMatrix::setTeamsCollide(int first, int second, bool collide)
+{
+  if (first < 0 || first >= kMaxTeams || second < 0 || second >= kMaxTeams || first == second)
+  {
+    return;
+  }
+  if (collide)
+  {
+    mTeamMasks[first] |= (uint64_t)1 << second;
+    mTeamMasks[second] |= (uint64_t)1 << first;
+  }
+  else
+  {
+    mTeamMasks[first] &= ~((uint64_t)1 << second);
+    mTeamMasks[second] &= ~((uint64_t)1 << first);
+  }
+}
+
+void CollisionMatrix::setTypesCollide(ObjectType first, ObjectType second, bool collide)
+{
+  if (collide)
+  {
+    mTypeMasks[(int)first] |= 1U << (int)second;
+    mTypeMasks[(int)second] |= 1U << (int)first;
+  }
+  else
+  {
+    mTypeMasks[(int)first] &= ~(1U << (int)second);
+    mTypeMasks[(int)second] &= ~(1U << (int)first);
+  }
+}
@@ -0,0 +1,65 @@
+/**
+ * @file CollisionMatrix.h
+ *
+ * Defines the rules for which objects may collide, by team and by type.
+ * GameBox sorts the collision candidates into a layer for each team and
+ * type in play, and uses the matrix to pick the pairs of layers worth
+ * searching, so a group that can't collide - a field of asteroids on one
+ * team, say - is never searched against itself at all.
+ *
+ * Objects on the same team never collide, as GraphObj::collidesWith has
+ * it; the matrix can only rule out more.  By default nothing else is
+ * ruled out.
+ */
+
+#ifndef COLLISION_MATRIX_H_2026_10_17
+#define COLLISION_MATRIX_H_2026_10_17
+
+#include <stdint.h>
+#include "GraphObj.h"
+
+class CollisionMatrix
+{
+public:
+  // Teams from zero up to this can be ruled out against each other.
+  // Those outside it always collide with other teams.
+  static const int kMaxTeams = 64;
+
+  CollisionMatrix();
+
+  // Sets whether objects on the two teams may collide.  Has no effect
+  // when the teams are the same.
+  void setTeamsCollide(int first, int second, bool collide);
+
+  // Sets whether objects of the two types may collide.
+  void setTypesCollide(ObjectType first, ObjectType second, bool collide);
+
+  bool teamsCollide(int first, int second) const
+  {
+    if (first == second)
+    {
+      return false;
+    }
+    if (first < 0 || first >= kMaxTeams || second < 0 || second >= kMaxTeams)
+    {
+      return true;
+    }
+    return ((mTeamMasks[first] >> second) & 1) != 0;
+  }
+
+  bool typesCollide(ObjectType first, ObjectType second) const
+  {
+    return ((mTypeMasks[(int)first] >> (int)second) & 1) != 0;
+  }
+
+  bool collides(int firstTeam, ObjectType firstType, int secondTeam, ObjectType secondType) const
+  {
+    return teamsCollide(firstTeam, secondTeam) && typesCollide(firstType, secondType);
+  }
+
+private:
+  uint64_t mTeamMasks[kMaxTeams]; // Bit k of row j: teams j and k may collide
+  uint32_t mTypeMasks[kObjectTypeCount];
+};
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * @file DeterminismTest.cpp
+ *
+ * Checks that a seeded game plays out the same on one thread as on
+ * several: the update and the narrowphase are split over the pool, but
+ * the hits must still be applied in the same order.
+ */
+
+#include <stdio.h>
+
+#include "TestScene.h"
+
+static const int kTicks = 200;
+static const int kThreads = 4;
+
+static int gFailures = 0;
+
+static void check(bool passed, const char *what)
+{
+  if (!passed)
+  {
+    printf("FAILED: %s\n", what);
+    gFailures++;
+  }
+}
+
+static TestSceneResult runOn(int threads)
+{
+  AsteroidField field;
+  field.setUpdateThreads(threads);
+  return runTestScene(&field, kTicks);
+}
+
+int main()
+{
+  TestSceneResult single = runOn(1);
+  TestSceneResult several = runOn(kThreads);
+
+  check(single.collisions == several.collisions, "the same collisions in every step");
+  check(single.objects.size() == several.objects.size(), "the same number of objects at the end");
+  check(single.objects == several.objects, "every object ends in the same state");
+
+  printf("%zu objects, up to %zu pairs tested in a step: %s\n",
+         single.objects.size(), single.peakCollisionTests, gFailures == 0 ? "passed" : "failed");
+  return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file EntityStore.cpp
+ *
+ * Implements the structure-of-arrays store of game object state.
+ */
+
+#include "EntityStore.h"
+#include "GraphObj.h"
+
+#include <algorithm>
+
+uint32_t EntityStore::add(const EntityState &state, const EntityTraits &traits)
+{
+  uint32_t row = (uint32_t)size();
+  resize(row + 1);
+  setState(row, state);
+  radius[row] = traits.radius;
+  boundingRadius[row] = traits.boundingRadius;
+  team[row] = traits.team;
+  fast[row] = traits.fast ? 1 : 0;
+  passive[row] = traits.passive ? 1 : 0;
+
+  uint32_t id;
+  if (mFreeIds.empty())
+  {
+    id = (uint32_t)mRowOf.size();
+    mRowOf.push_back(row);
+  }
+  else
+  {
+    id = mFreeIds.back();
+    mFreeIds.pop_back();
+    mRowOf[id] = row;
+  }
+  entity[row] = id;
+  return id;
+}
+
+template <typename Value>
+static void moveColumn(std::vector<Value> *column, const std::vector<EntityStore::RowRun> &runs)
+{
+  Value *values = column->data();
+  for (auto &run : runs)
+  {
+    std::copy(values + run.from, values + run.from + run.count, values + run.to);
+  }
+}
+
+void EntityStore::moveRows(const std::vector<RowRun> &runs)
+{
+  moveColumn(&positionX, runs);
+  moveColumn(&positionY, runs);
+  moveColumn(&velocityX, runs);
+  moveColumn(&velocityY, runs);
+  moveColumn(&angle, runs);
+  moveColumn(&radialVelocity, runs);
+  moveColumn(&lastMoveX, runs);
+  moveColumn(&lastMoveY, runs);
+  moveColumn(&lastTurn, runs);
+  moveColumn(&life, runs);
+  moveColumn(&alive, runs);
+  moveColumn(&radius, runs);
+  moveColumn(&boundingRadius, runs);
+  moveColumn(&team, runs);
+  moveColumn(&fast, runs);
+  moveColumn(&passive, runs);
+  moveColumn(&entity, runs);
+
+  for (auto &run : runs)
+  {
+    for (uint32_t row = run.to; row < run.to + run.count; row++)
+    {
+      mRowOf[entity[row]] = row;
+    }
+  }
+}
+
+void EntityStore::resize(size_t count)
+{
+  positionX.resize(count);
+  positionY.resize(count);
+  velocityX.resize(count);
+  velocityY.resize(count);
+  angle.resize(count);
+  radialVelocity.resize(count);
+  lastMoveX.resize(count);
+  lastMoveY.resize(count);
+  lastTurn.resize(count);
+  life.resize(count);
+  alive.resize(count);
+  radius.resize(count);
+  boundingRadius.resize(count);
+  team.resize(count);
+  fast.resize(count);
+  passive.resize(count);
+  entity.resize(count);
+}
+
+bool EntityStore::advance(uint32_t row, float deltaSeconds, sf::Vector2f limits)
+{
+  if (life[row] > 0)
+  {
+    life[row] -= deltaSeconds;
+  }
+  if (life[row] <= 0)
+  {
+    life[row] = 0;
+    alive[row] = 0;
+  }
+
+  lastMoveX[row] = velocityX[row] * deltaSeconds;
+  lastMoveY[row] = velocityY[row] * deltaSeconds;
+  positionX[row] += lastMoveX[row];
+  positionY[row] += lastMoveY[row];
+  lastTurn[row] = radialVelocity[row] * deltaSeconds;
+  angle[row] += lastTurn[row];
+  if (angle[row] > 2 * PI)
+  {
+    angle[row] -= 2 * PI;
+  }
+  if (angle[row] < -2 * PI)
+  {
+    angle[row] += 2 * PI;
+  }
+
+  return positionX[row] < 0 || positionX[row] > limits.x || positionY[row] < 0 || positionY[row] > limits.y;
+}
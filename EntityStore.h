@@ -0,0 +1,150 @@
+/**
+ * @file EntityStore.h
+ *
+ * Defines the store that holds the state of the objects in a game box as
+ * a structure of arrays: each property in its own contiguous array, with
+ * a row for each object, in the box's object order.  While an object is
+ * in a box its moving state lives in its row, and the object is a view
+ * onto it, so the passes over every object (clearing out the dead,
+ * moving the passive objects, gathering the collision envelopes) walk
+ * memory in order instead of chasing object pointers.
+ *
+ * An object finds its row through an entity id, which stays the same
+ * while the rows are packed down, so packing never touches the objects.
+ */
+
+#ifndef ENTITY_STORE_H_2026_10_17
+#define ENTITY_STORE_H_2026_10_17
+
+#include <limits>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include <SFML/System/Vector2.hpp>
+
+// What changes as an object moves and lives.  An object outside any
+// store keeps this itself.
+struct EntityState
+{
+  sf::Vector2f position;
+  sf::Vector2f velocity;
+  float angle = 0; // Radians
+  float radialVelocity = 0;
+  sf::Vector2f lastMove; // Distance moved in the last update
+  float lastTurn = 0;    // Angle turned in the last update
+  float life = std::numeric_limits<float>::infinity(); // Seconds left; infinite with no lifespan
+  bool alive = true;
+};
+
+// What an object is given when it is made, copied into its row for the
+// passes that read it.
+struct EntityTraits
+{
+  float radius = 0;         // The collision radius
+  float boundingRadius = 0; // Round the outline, for the polygon narrowphase
+  int team = 0;
+  bool fast = false;
+  bool passive = false;
+};
+
+struct EntityStore
+{
+  size_t size() const { return positionX.size(); }
+
+  // Appends a row, returning the id of its entity.
+  uint32_t add(const EntityState &state, const EntityTraits &traits);
+
+  // Frees an entity's id, once its row is no longer used.
+  void release(uint32_t id) { mFreeIds.push_back(id); }
+
+  uint32_t getRow(uint32_t id) const { return mRowOf[id]; }
+
+  // A run of rows moving down together, as the rows are packed.
+  struct RowRun
+  {
+    uint32_t from = 0;
+    uint32_t to = 0;
+    uint32_t count = 0;
+  };
+
+  // Moves each run down, in order, keeping each moved entity's row up to
+  // date.  Runs only move towards the front, so each array is moved a
+  // run at a time, as a block.
+  void moveRows(const std::vector<RowRun> &runs);
+
+  // Keeps the first count rows.
+  void resize(size_t count);
+
+  // Moves a row on by deltaSeconds as GraphObj::update moves an object:
+  // its life runs down, and it drifts and turns at its speeds.  Returns
+  // true if it has left the space, and needs wrapping.
+  bool advance(uint32_t row, float deltaSeconds, sf::Vector2f limits);
+
+  EntityState getState(uint32_t row) const
+  {
+    EntityState state;
+    state.position = getPosition(row);
+    state.velocity = getVelocity(row);
+    state.angle = angle[row];
+    state.radialVelocity = radialVelocity[row];
+    state.lastMove = getLastMove(row);
+    state.lastTurn = lastTurn[row];
+    state.life = life[row];
+    state.alive = alive[row] != 0;
+    return state;
+  }
+
+  void setState(uint32_t row, const EntityState &state)
+  {
+    setPosition(row, state.position);
+    setVelocity(row, state.velocity);
+    angle[row] = state.angle;
+    radialVelocity[row] = state.radialVelocity;
+    lastMoveX[row] = state.lastMove.x;
+    lastMoveY[row] = state.lastMove.y;
+    lastTurn[row] = state.lastTurn;
+    life[row] = state.life;
+    alive[row] = state.alive ? 1 : 0;
+  }
+
+  sf::Vector2f getPosition(uint32_t row) const { return sf::Vector2f(positionX[row], positionY[row]); }
+  void setPosition(uint32_t row, sf::Vector2f position)
+  {
+    positionX[row] = position.x;
+    positionY[row] = position.y;
+  }
+
+  sf::Vector2f getVelocity(uint32_t row) const { return sf::Vector2f(velocityX[row], velocityY[row]); }
+  void setVelocity(uint32_t row, sf::Vector2f velocity)
+  {
+    velocityX[row] = velocity.x;
+    velocityY[row] = velocity.y;
+  }
+
+  sf::Vector2f getLastMove(uint32_t row) const { return sf::Vector2f(lastMoveX[row], lastMoveY[row]); }
+
+  std::vector<float> positionX;
+  std::vector<float> positionY;
+  std::vector<float> velocityX;
+  std::vector<float> velocityY;
+  std::vector<float> angle;
+  std::vector<float> radialVelocity;
+  std::vector<float> lastMoveX;
+  std::vector<float> lastMoveY;
+  std::vector<float> lastTurn;
+  std::vector<float> life;
+  std::vector<uint8_t> alive;
+
+  std::vector<float> radius;
+  std::vector<float> boundingRadius;
+  std::vector<int> team;
+  std::vector<uint8_t> fast;
+  std::vector<uint8_t> passive;
+  std::vector<uint32_t> entity; // The id of the entity in each row
+
+private:
+  std::vector<uint32_t> mRowOf; // The row of each entity id
+  std::vector<uint32_t> mFreeIds;
+};
+
+#endif
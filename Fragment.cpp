@@ -9,12 +9,12 @@
 static const float kMinSideRatio = 0.25F;
 static const float kMaxSideRatio = 0.75F;
 
-static float randSide(const Fragment::Config &config)
+static float randSide(const Fragment::Config &config, Random &random)
 {
-  return randFloat(config.size * kMinSideRatio, config.size * kMaxSideRatio);
+  return random.randFloat(config.size * kMinSideRatio, config.size * kMaxSideRatio);
 }
 
-Fragment::Fragment(const Config &config) : GraphObj()
+Fragment::Fragment(const Config &config, Random &random) : GraphObj()
 {
   if (config.isFire)
   {
@@ -30,17 +30,19 @@ Fragment::Fragment(const Config &config) : GraphObj()
   else
   {
     sf::VertexArray spike(sf::Quads, 4);
-    spike[0].position = sf::Vector2f(randSide(config), randSide(config));
-    spike[1].position = sf::Vector2f(randSide(config), -randSide(config));
-    spike[2].position = sf::Vector2f(-randSide(config), -randSide(config));
-    spike[3].position = sf::Vector2f(-randSide(config), randSide(config));
+    spike[0].position = sf::Vector2f(randSide(config, random), randSide(config, random));
+    spike[1].position = sf::Vector2f(randSide(config, random), -randSide(config, random));
+    spike[2].position = sf::Vector2f(-randSide(config, random), -randSide(config, random));
+    spike[3].position = sf::Vector2f(-randSide(config, random), randSide(config, random));
     spike[0].color = config.color;
     spike[1].color = config.color;
     spike[2].color = config.color;
     spike[3].color = config.color;
     mModelShapes.push_back(spike);
   }
-  mRemainingLifeSeconds = config.lifespanSeconds;
+  setLifespan(config.lifespanSeconds);
+  mType = ObjectType::Fragment;
+  mIsPassive = true;
 
   // No collision radius - fragments only for show.
   mCollisionRadius = 0;
@@ -48,21 +50,5 @@ Fragment::Fragment(const Config &config) : GraphObj()
 
 void Fragment::onOutOfBounds(UpdateContext *context)
 {
-  mIsAlive = false;
-}
-
-void Fragment::update(sf::Time deltaT, UpdateContext *context)
-{
-  if (mRemainingLifeSeconds > 0)
-  {
-    mRemainingLifeSeconds -= deltaT.asSeconds();
-  }
-
-  if (mRemainingLifeSeconds <= 0)
-  {
-    mRemainingLifeSeconds = 0;
-    mIsAlive = false;
-  }
-
-  GraphObj::update(deltaT, context);
+  kill();
 }
@@ -9,7 +9,7 @@
 
 #include "GraphObj.h"
 
-class Fragment : public GraphObj
+class Fragment final : public GraphObj
 {
 public:
 
@@ -21,14 +21,9 @@ public:
     float lifespanSeconds;
   };
 
-  Fragment(const Config &config);
+  Fragment(const Config &config, Random &random);
 
   void onOutOfBounds(UpdateContext *context) override;
-
-  void update(sf::Time deltaT, UpdateContext *context) override;
-
-private:
-  float mRemainingLifeSeconds = 0;
 };
 
 #endif
\ No newline at end of file
@@ -6,157 +6,919 @@
 
 #include "GameBox.h"
 #include <SFML/System/Clock.hpp>
+#include "CollisionKernel.h"
 #include "Fragment.h"
+#include "ObjectDispatch.h"
+#include "ObjectPool.h"
+#include "PolygonCollision.h"
 
 #include <stdlib.h>
+#include <algorithm>
 #include <unordered_map>
 
-void GameBox::checkForCollisions(GraphObj::UpdateContext *context)
+// Objects are updated in fixed size chunks, each with its own spawn list.
+// The chunks don't depend on the thread count, which keeps the results
+// the same however many threads run them.
+static const size_t kUpdateChunkSize = 256;
+
+// Below this many objects, handing work to other threads costs more
+// than it saves.
+static const size_t kMinParallelObjects = 2 * kUpdateChunkSize;
+
+// The same for the candidate pairs in the collision narrowphase.
+static const size_t kPairChunkSize = 1024;
+static const size_t kMinParallelPairs = 2 * kPairChunkSize;
+
+// Calls function with the object as its final type, or through the
+// vtable as a GraphObj when static dispatch is off.
+template <typename Object, typename Function>
+static auto dispatch(bool staticDispatch, Object &obj, Function &&function) -> decltype(function(obj))
 {
-  // TODO: use a more efficient method to check
-  //       for collisions.
-  //
+  return staticDispatch ? visitObject(obj, function) : function(obj);
+}
 
-  // Divide into teams, and filter out things that don't collide.
+// The stats overlay: a column per frame, with a line at the height of a
+// 60 Hz frame.  The phases are stacked in the order update, collisions,
+// explosions, spawn merge, particles and render.
+static const size_t kOverlayFrameCount = 120;
+static const float kOverlayColumnWidth = 2;
+static const float kOverlayMargin = 10;
+static const float kOverlayHeight = 200;
+static const float kOverlayTargetHeight = 100;
+static const sf::Time kOverlayFrameTarget = sf::microseconds(16667);
+static const sf::Color kOverlayBackground(0, 0, 0, 160);
+static const sf::Color kOverlayPhaseColors[] =
+{
+  sf::Color(0, 255, 0), sf::Color(255, 0, 0), sf::Color(255, 145, 0),
+  sf::Color(0, 0, 255), sf::Color(255, 255, 0), sf::Color(255, 0, 255)
+};
 
-  std::list<std::shared_ptr<GraphObj>> collideCandidates;
+// GraphObj::getSweptEnvelope, worked out from the object's row.
+static CollisionEnvelope getSweptEnvelope(const EntityStore &entities, uint32_t row, bool bounding)
+{
+  CollisionEnvelope envelope(entities.getPosition(row), bounding ? entities.boundingRadius[row] : entities.radius[row]);
+  if (entities.fast[row])
+  {
+    sf::Vector2f lastMove = entities.getLastMove(row);
+    float moveLength = sqrt(lastMove.x * lastMove.x + lastMove.y * lastMove.y);
+    envelope.center -= lastMove * 0.5F;
+    envelope.radius += moveLength * 0.5F;
+  }
+  return envelope;
+}
+
+GameBox::~GameBox()
+{
+  // The objects may outlive the box, so they take their state back.
   for (auto &obj : mObjects)
   {
-    if (obj && obj->isAlive() && obj->canCollide())
+    if (obj)
+    {
+      obj->detach();
+    }
+  }
+}
+
+void GameBox::attachObject(const std::shared_ptr<GraphObj> &obj)
+{
+  assert(mEntities.size() == mObjects.size());
+  obj->attach(&mEntities);
+  mObjects.push_back(obj);
+}
+
+void GameBox::checkForCollisions(GraphObj::UpdateContext *context)
+{
+  // Filter out things that don't collide, gathering what the search
+  // needs from the rows in the one pass.  Only the candidates' object
+  // pointers are looked at, not the objects.
+  mCollideCandidates.clear();
+  mCollideEnvelopes.clear();
+  mCollideTeams.clear();
+  mCollideFast.clear();
+  mCollidePositions.clear();
+  mUnindexedPositions.clear();
+  for (uint32_t row = 0; row < (uint32_t)mObjects.size(); row++)
+  {
+    GraphObj *obj = mObjects[row].get();
+    if (obj == nullptr)
+    {
+      continue;
+    }
+    if (!mEntities.alive[row] || mEntities.radius[row] <= 0)
+    {
+      mUnindexedPositions.push_back(row);
+      continue;
+    }
+    mCollidePositions.push_back(row);
+    mCollideCandidates.push_back(obj);
+    mCollideEnvelopes.push_back(getSweptEnvelope(mEntities, row, mPolygonCollisions));
+    mCollideTeams.push_back(mEntities.team[row]);
+    mCollideFast.push_back(mEntities.fast[row]);
+  }
+  mCollided.assign(mCollideCandidates.size(), false);
+
+  // Place each outline once, rather than once for every pair it's in.
+  mOutlinePoints.clear();
+  mOutlineFirst.clear();
+  mOutlineCount.clear();
+  mOutlineInner.clear();
+  if (mPolygonCollisions)
+  {
+    for (auto obj : mCollideCandidates)
+    {
+      GraphObj::CollisionOutline outline = dispatch(mStaticDispatch, *obj, [](const auto &shape)
+      {
+        return shape.getCollisionOutline();
+      });
+      int count = std::min(outline.pointCount, PolygonCollision::kMaxOutlinePoints);
+      AngleFactors angleFact(obj->getAngle());
+      mOutlineFirst.push_back((int)mOutlinePoints.size());
+      mOutlineCount.push_back(count);
+      mOutlineInner.push_back(count > 0 ? outline.innerRadius * outline.scale : obj->getCollisionRadius());
+      for (int point = 0; point < count; point++)
+      {
+        sf::Vector2f pt = outline.points[point] * outline.scale;
+        mOutlinePoints.push_back(sf::Vector2f(pt.x * angleFact.cosFactor - pt.y * angleFact.sinFactor,
+                                              pt.x * angleFact.sinFactor + pt.y * angleFact.cosFactor));
+      }
+    }
+  }
+
+  buildCollisionLayers();
+  if (mCollisionMode == CollisionMode::BruteForce)
+  {
+    checkForCollisionsBruteForce(context);
+    return;
+  }
+
+  mCollidePairs.clear();
+  if (mCollisionMode == CollisionMode::SweepAndPrune)
+  {
+    mSweepAndPrune.update(mCollideCandidates, mCollideEnvelopes, context->spaceLimits);
+    mSweepAndPrune.findPairs(&mCollidePairs);
+
+    // Drop the pairs the collision matrix rules out before the
+    // narrowphase sees them.
+    mCollidePairs.erase(std::remove_if(mCollidePairs.begin(), mCollidePairs.end(),
+                                       [this](const std::pair<int, int> &pair)
+                                       {
+                                         return !layersCollide(pair.first, pair.second);
+                                       }),
+                        mCollidePairs.end());
+  }
+  else
+  {
+    // Only pairs whose envelopes overlap come out, and only from layers
+    // that may collide.
+    findLayerOverlaps(context->spaceLimits);
+    mQueryIndexValid = true;
+    mQueryIndexLimits = context->spaceLimits;
+    mIndexEnd = mObjects.size();
+  }
+
+  resolveCollisionPairs(context);
+}
+
+bool GameBox::pairCollides(size_t first, size_t second, GraphObj::UpdateContext *context, sf::Vector2f wrapSpan) const
+{
+  // A slow object's envelope is its collision circle, so a pair of them
+  // only needs the circle test; a fast object needs its swept test.
+  // With outlines, the envelopes are the bounding circles, which must
+  // meet before the outlines can.
+  if (mPolygonCollisions && (mOutlineCount[first] > 0 || mOutlineCount[second] > 0))
+  {
+    return CollisionKernel::overlaps(mCollideEnvelopes[first], mCollideTeams[first],
+                                     mCollideEnvelopes[second], mCollideTeams[second],
+                                     wrapSpan) &&
+           outlinesCollide(first, second, wrapSpan);
+  }
+  if (mCollideFast[first] || mCollideFast[second])
+  {
+    const GraphObj &other = *mCollideCandidates[second];
+    return dispatch(mStaticDispatch, *mCollideCandidates[first], [&](auto &obj)
+    {
+      return obj.collidesWith(other, context);
+    });
+  }
+  return CollisionKernel::overlaps(mCollideEnvelopes[first], mCollideTeams[first],
+                                   mCollideEnvelopes[second], mCollideTeams[second],
+                                   wrapSpan);
+}
+
+bool GameBox::outlinesCollide(size_t first, size_t second, sf::Vector2f wrapSpan) const
+{
+  // Work about the center of the outlined one
+  size_t outlined = first;
+  size_t other = second;
+  if (mOutlineCount[outlined] == 0)
+  {
+    std::swap(outlined, other);
+  }
+  const GraphObj *outlinedObj = mCollideCandidates[outlined];
+  const GraphObj *otherObj = mCollideCandidates[other];
+  sf::Vector2f delta = otherObj->getPosition() - outlinedObj->getPosition();
+  delta.x = CollisionKernel::wrapDelta(delta.x, wrapSpan.x);
+  delta.y = CollisionKernel::wrapDelta(delta.y, wrapSpan.y);
+  const sf::Vector2f *polygon = &mOutlinePoints[mOutlineFirst[outlined]];
+  int count = mOutlineCount[outlined];
+
+  // Circles that fit inside each shape are a quick way to catch a hit.
+  float innerDistance = mOutlineInner[outlined] + mOutlineInner[other];
+  if (delta.x * delta.x + delta.y * delta.y < innerDistance * innerDistance)
+  {
+    return true;
+  }
+
+  int otherCount = mOutlineCount[other];
+  if (otherCount > 0)
+  {
+    sf::Vector2f placed[PolygonCollision::kMaxOutlinePoints];
+    const sf::Vector2f *otherPoints = &mOutlinePoints[mOutlineFirst[other]];
+    for (int point = 0; point < otherCount; point++)
+    {
+      placed[point] = otherPoints[point] + delta;
+    }
+    return PolygonCollision::polygonsOverlap(polygon, count, CollisionEnvelope(sf::Vector2f(), outlinedObj->getBoundingRadius()),
+                                             placed, otherCount, CollisionEnvelope(delta, otherObj->getBoundingRadius()));
+  }
+
+  // The other is a circle, swept along its path relative to the outline
+  // when either is fast, as in GraphObj::collidesWith.
+  sf::Vector2f start = delta;
+  if (mCollideFast[first] || mCollideFast[second])
+  {
+    start -= otherObj->getLastMove() - outlinedObj->getLastMove();
+  }
+  return PolygonCollision::circleHits(polygon, count, start, delta, otherObj->getCollisionRadius());
+}
+
+void GameBox::buildCollisionLayers()
+{
+  mLayerCount = 0;
+  mCandidateLayer.resize(mCollideCandidates.size());
+  size_t layer = 0;
+  for (size_t candidate = 0; candidate < mCollideCandidates.size(); candidate++)
+  {
+    int team = mCollideTeams[candidate];
+    ObjectType type = mCollideCandidates[candidate]->getType();
+
+    // Objects tend to come in runs of the same kind, so try the last
+    // layer before the rest.
+    if (layer >= mLayerCount || mLayers[layer].team != team || mLayers[layer].type != type)
     {
-      collideCandidates.push_back(obj);
+      layer = 0;
+      while (layer < mLayerCount && (mLayers[layer].team != team || mLayers[layer].type != type))
+      {
+        layer++;
+      }
+      if (layer == mLayerCount)
+      {
+        if (mLayers.size() == mLayerCount)
+        {
+          mLayers.emplace_back();
+        }
+        mLayers[layer].team = team;
+        mLayers[layer].type = type;
+        mLayers[layer].members.clear();
+        mLayerCount++;
+      }
     }
+    mLayers[layer].members.push_back((int)candidate);
+    mCandidateLayer[candidate] = (int)layer;
   }
 
+  mLayerPairs.resize(mLayerCount * mLayerCount);
+  for (size_t first = 0; first < mLayerCount; first++)
+  {
+    for (size_t second = 0; second < mLayerCount; second++)
+    {
+      mLayerPairs[first * mLayerCount + second] =
+        mCollisionMatrix.collides(mLayers[first].team, mLayers[first].type,
+                                  mLayers[second].team, mLayers[second].type);
+    }
+  }
+}
+
+void GameBox::findLayerOverlaps(sf::Vector2u spaceLimits)
+{
+  for (size_t index = 0; index < mLayerCount; index++)
+  {
+    CollisionLayer &layer = mLayers[index];
+    layer.envelopes.clear();
+    layer.teams.assign(layer.members.size(), layer.team);
+    for (int member : layer.members)
+    {
+      layer.envelopes.push_back(mCollideEnvelopes[member]);
+    }
+    layer.grid.build(layer.envelopes, layer.teams, spaceLimits);
+  }
+
+  // A layer is all one team, so it never collides with itself.  For the
+  // other pairs, look up each envelope of the smaller layer in the grid
+  // of the larger, which tests its cells as blocks with the kernel.
+  sf::Vector2f wrapSpan = CollisionKernel::getWrapSpan(spaceLimits);
+  for (size_t first = 0; first < mLayerCount; first++)
+  {
+    for (size_t second = first + 1; second < mLayerCount; second++)
+    {
+      if (!mLayerPairs[first * mLayerCount + second])
+      {
+        continue;
+      }
+      const CollisionLayer *searching = &mLayers[first];
+      const CollisionLayer *searched = &mLayers[second];
+      if (searching->members.size() > searched->members.size())
+      {
+        std::swap(searching, searched);
+      }
+      for (int member : searching->members)
+      {
+        mNearIndices.clear();
+        searched->grid.findNear(mCollideEnvelopes[member], searching->team, wrapSpan, &mNearIndices);
+        for (int index : mNearIndices)
+        {
+          int other = searched->members[index];
+          mCollidePairs.push_back(std::make_pair(std::min(member, other), std::max(member, other)));
+        }
+      }
+    }
+  }
+}
+
+void GameBox::notifyCollision(size_t candidate)
+{
+  dispatch(mStaticDispatch, *mCollideCandidates[candidate], [](auto &obj) { obj.onCollision(); });
+}
+
+void GameBox::checkForCollisionsBruteForce(GraphObj::UpdateContext *context)
+{
   // Inefficient O(N^2) search
-  auto i = collideCandidates.begin();
-  while (i != collideCandidates.end())
+  sf::Vector2f wrapSpan = CollisionKernel::getWrapSpan(context->spaceLimits);
+  for (size_t i = 0; i < mCollideCandidates.size(); i++)
   {
-    bool collision = false;
-    auto j = collideCandidates.begin();
-    while (j != collideCandidates.end())
+    if (mCollided[i])
+    {
+      continue;
+    }
+    for (size_t j = 0; j < mCollideCandidates.size(); j++)
     {
-      if (i != j)
+      if (i != j && !mCollided[j] && layersCollide(i, j))
       {
-        auto oi = *i;
-        auto oj = *j;
-        if (oi && oj)
+        mLastStepCounts.collisionTests++;
+        if (pairCollides(i, j, context, wrapSpan))
         {
-          if (oi->collidesWith(*oj, context))
-          {
-            oi->onCollision();
-            oj->onCollision();
-            j = collideCandidates.erase(j);
-
-            // Only allow one collision
-            collision = true;
-            break;
-          }
+          mLastStepCounts.collisions++;
+          notifyCollision(i);
+          notifyCollision(j);
+
+          // Only allow one collision
+          mCollided[i] = true;
+          mCollided[j] = true;
+          break;
         }
       }
-      ++j;
     }
-    if (collision)
+  }
+}
+
+void GameBox::resolveCollisionPairs(GraphObj::UpdateContext *context)
+{
+  // collidesWith gives the same answer from either side, so the brute
+  // force search can only ever resolve a pair from its lower object.
+  // Sorting the pairs therefore reproduces its order, whatever order
+  // the broadphase found them in.
+  std::sort(mCollidePairs.begin(), mCollidePairs.end());
+
+  // Narrowphase: test every pair, recording the hits.  Nothing changes
+  // state here, so the pairs can be split over threads.
+  sf::Vector2f wrapSpan = CollisionKernel::getWrapSpan(context->spaceLimits);
+  size_t pairCount = mCollidePairs.size();
+  mLastStepCounts.collisionTests += pairCount;
+  mPairHits.resize(pairCount);
+  int chunkCount = (int)((pairCount + kPairChunkSize - 1) / kPairChunkSize);
+  auto testChunk = [&](int chunk)
+  {
+    size_t end = std::min(pairCount, (chunk + 1) * kPairChunkSize);
+    for (size_t index = chunk * kPairChunkSize; index < end; index++)
+    {
+      auto &pair = mCollidePairs[index];
+      mPairHits[index] = pairCollides(pair.first, pair.second, context, wrapSpan);
+    }
+  };
+  if (mThreadPool && pairCount >= kMinParallelPairs)
+  {
+    mThreadPool->run(chunkCount, testChunk);
+  }
+  else
+  {
+    for (int chunk = 0; chunk < chunkCount; chunk++)
+    {
+      testChunk(chunk);
+    }
+  }
+
+  // Resolution: apply the hits in order, where the first collision for
+  // an object wins.
+  for (size_t index = 0; index < pairCount; index++)
+  {
+    if (!mPairHits[index])
     {
-      i = collideCandidates.erase(i);
+      continue;
     }
-    else
+    auto &pair = mCollidePairs[index];
+    if (mCollided[pair.first] || mCollided[pair.second])
     {
-      ++i;
+      continue;
     }
+    notifyCollision(pair.first);
+    notifyCollision(pair.second);
+    mLastStepCounts.collisions++;
+
+    // Only allow one collision
+    mCollided[pair.first] = true;
+    mCollided[pair.second] = true;
   }
-} 
+}
 
-void GameBox::update(sf::RenderWindow &win)
+void GameBox::update(sf::RenderTarget &target)
 {
   sf::Time currentTime = mClock.getElapsedTime();
   sf::Time deltaTime = sf::Time::Zero;
+  if (mStatsEnabled)
+  {
+    mFrameStats = FrameStats();
+  }
 
   if (mLastUpdateTimeValid)
   {
     deltaTime = currentTime - mLastUpdateTime;
+    mParticles.setFrameTime(deltaTime);
   }
 
-  GraphObj::UpdateContext context;
-  context.spaceLimits = win.getSize();
+  float interpolation = 1;
+  if (mFixedTimestep)
+  {
+    mTickAccumulator += deltaTime;
+    int steps = 0;
+    while (mTickAccumulator >= mTickTime && steps < mMaxCatchUpSteps)
+    {
+      step(mTickTime, target.getSize());
+      mTickAccumulator -= mTickTime;
+      steps++;
+    }
+    if (mTickAccumulator >= mTickTime)
+    {
+      // Too far behind to catch up - let the time go
+      mTickAccumulator = sf::microseconds(mTickAccumulator.asMicroseconds() % mTickTime.asMicroseconds());
+    }
+    interpolation = mTickAccumulator.asSeconds() / mTickTime.asSeconds();
+  }
+  else
+  {
+    step(deltaTime, target.getSize());
+  }
 
-  std::list <std::shared_ptr<GraphObj>> totalEjecta;
-  auto objIter = mObjects.begin();
-  while (objIter != mObjects.end())
+  sf::Clock renderClock;
+  render(target, interpolation);
+  if (mStatsEnabled)
+  {
+    mFrameStats.render = renderClock.getElapsedTime();
+    countObjects();
+  }
+  if (mStatsOverlay)
   {
-    bool isAlive = false;
-    auto obj = *objIter;
-    if (obj && obj->isAlive())
+    drawStatsOverlay(target);
+  }
+
+  mLastUpdateTimeValid = true;
+  mLastUpdateTime = currentTime;
+}
+
+void GameBox::StepTimes::add(const StepTimes &other)
+{
+  particles += other.particles;
+  explosions += other.explosions;
+  update += other.update;
+  collisions += other.collisions;
+  spawnMerge += other.spawnMerge;
+}
+
+void GameBox::StepCounts::add(const StepCounts &other)
+{
+  explosions += other.explosions;
+  ejecta += other.ejecta;
+  collisionTests += other.collisionTests;
+  collisions += other.collisions;
+  spawns += other.spawns;
+}
+
+void GameBox::setStatsOverlay(bool enabled)
+{
+  mStatsOverlay = enabled;
+  mStatsEnabled = mStatsRequested || mStatsOverlay;
+  mOverlayFrames.assign(enabled ? kOverlayFrameCount : 0, FrameStats());
+  mOverlayNext = 0;
+}
+
+void GameBox::countIn(const GraphObj &obj)
+{
+  mObjectCount++;
+  mTypeCounts[(int)obj.getType()]++;
+  int team = obj.getTeam();
+  if (team >= 0)
+  {
+    if (team >= (int)mTeamCounts.size())
     {
-      isAlive = true;
+      mTeamCounts.resize(team + 1, 0);
     }
-    if (!isAlive)
+    mTeamCounts[team]++;
+  }
+}
+
+void GameBox::countOut(const GraphObj &obj)
+{
+  mObjectCount--;
+  mTypeCounts[(int)obj.getType()]--;
+  int team = obj.getTeam();
+  if (team >= 0 && team < (int)mTeamCounts.size())
+  {
+    mTeamCounts[team]--;
+  }
+}
+
+void GameBox::countObjects()
+{
+  mFrameStats.objects = mObjectCount;
+  for (int type = 0; type < kObjectTypeCount; type++)
+  {
+    mFrameStats.objectsByType[type] = mTypeCounts[type];
+  }
+  mFrameStats.particles = mParticles.size();
+}
+
+void GameBox::drawStatsOverlay(sf::RenderTarget &target)
+{
+  mOverlayFrames[mOverlayNext] = mFrameStats;
+  mOverlayNext = (mOverlayNext + 1) % mOverlayFrames.size();
+
+  mOverlayBatch.clear();
+  sf::Vector2f origin(kOverlayMargin, kOverlayMargin);
+  float width = kOverlayFrameCount * kOverlayColumnWidth;
+  mOverlayBatch.addRectangle(origin, sf::Vector2f(width, kOverlayHeight), kOverlayBackground);
+
+  // Oldest on the left, each column stacked up from the bottom
+  for (size_t column = 0; column < mOverlayFrames.size(); column++)
+  {
+    const FrameStats &frame = mOverlayFrames[(mOverlayNext + column) % mOverlayFrames.size()];
+    const sf::Time phases[] =
+    {
+      frame.stepTimes.update, frame.stepTimes.collisions, frame.stepTimes.explosions,
+      frame.stepTimes.spawnMerge, frame.stepTimes.particles, frame.render
+    };
+    float x = origin.x + column * kOverlayColumnWidth;
+    float bottom = origin.y + kOverlayHeight;
+    for (size_t phase = 0; phase < sizeof(phases) / sizeof(phases[0]); phase++)
+    {
+      float height = std::min(phases[phase].asSeconds() / kOverlayFrameTarget.asSeconds() * kOverlayTargetHeight,
+                              bottom - origin.y);
+      if (height > 0)
+      {
+        mOverlayBatch.addRectangle(sf::Vector2f(x, bottom - height), sf::Vector2f(kOverlayColumnWidth, height),
+                                   kOverlayPhaseColors[phase]);
+        bottom -= height;
+      }
+    }
+  }
+
+  float targetY = origin.y + kOverlayHeight - kOverlayTargetHeight;
+  mOverlayBatch.addRectangle(sf::Vector2f(origin.x, targetY), sf::Vector2f(width, 1), sf::Color(255, 255, 255));
+  mOverlayBatch.draw(target);
+}
+
+void GameBox::setFixedTimestep(int ticksPerSecond, int maxCatchUpSteps)
+{
+  mFixedTimestep = ticksPerSecond > 0;
+  if (mFixedTimestep)
+  {
+    mTickTime = sf::microseconds(1000000 / ticksPerSecond);
+  }
+  mMaxCatchUpSteps = maxCatchUpSteps > 0 ? maxCatchUpSteps : 1;
+  mTickAccumulator = sf::Time::Zero;
+}
+
+void GameBox::step(sf::Time deltaTime, sf::Vector2u spaceLimits)
+{
+  uint64_t heapAllocationsBefore = getPoolStats().heapAllocations;
+  mQueryIndexValid = false;
+  mLastStepCounts = StepCounts();
+  mLastStepTimes = StepTimes();
+  sf::Clock phaseClock;
+  auto lap = [&](sf::Time *phase)
+  {
+    if (mStatsEnabled)
+    {
+      *phase += phaseClock.restart();
+    }
+  };
+
+  GraphObj::UpdateContext context;
+  context.spaceLimits = spaceLimits;
+  context.random = &mRandom;
+  context.particles = &mParticles;
+
+  // Move the particles before the explosions below add new ones, which
+  // like any new object first move on the next step.
+  mParticles.update(deltaTime, spaceLimits);
+  lap(&mLastStepTimes.particles);
+
+  mEjecta.clear();
+  mRowRuns.clear();
+  size_t keepCount = 0;
+  for (size_t index = 0; index < mObjects.size(); index++)
+  {
+    auto &obj = mObjects[index];
+    uint32_t slot = mObjectSlots[index];
+    if (!obj || !mEntities.alive[index])
     {
       if (obj)
       {
-        if (obj->explodesOnDeath())
+        if (dispatch(mStaticDispatch, *obj, [](const auto &dying) { return dying.explodesOnDeath(); }))
         {
-          auto ejecta = obj->explode();
-          totalEjecta.splice(totalEjecta.end(), ejecta);
+          dispatch(mStaticDispatch, *obj, [&](auto &dying) { dying.explode(&mEjecta, &context); });
+          mLastStepCounts.explosions++;
         }
+        countOut(*obj);
+        obj->detach();
+      }
+      // Remove inactive objects, handing pooled ones straight back
+      obj.reset();
+      if (slot != ObjectHandle::kNullSlot)
+      {
+        mHandles.release(slot);
       }
-      // Remove inactive objects
-      objIter = mObjects.erase(objIter);
+      continue;
     }
-    else
+
+    // Pack the survivors down in place, keeping their order.  Their rows
+    // follow once the runs of survivors are known.
+    if (keepCount != index)
     {
-      obj->update(deltaTime, &context);
-      obj->render(win);
-      ++objIter;
+      if (!mRowRuns.empty() && mRowRuns.back().from + mRowRuns.back().count == index)
+      {
+        mRowRuns.back().count++;
+      }
+      else
+      {
+        EntityStore::RowRun run;
+        run.from = (uint32_t)index;
+        run.to = (uint32_t)keepCount;
+        run.count = 1;
+        mRowRuns.push_back(run);
+      }
+      mObjects[keepCount] = std::move(obj);
+      mObjectSlots[keepCount] = slot;
+      if (slot != ObjectHandle::kNullSlot)
+      {
+        mHandles.setPosition(slot, (uint32_t)keepCount);
+      }
     }
+    keepCount++;
   }
+  mObjects.resize(keepCount);
+  mObjectSlots.resize(keepCount);
+  mEntities.moveRows(mRowRuns);
+  mEntities.resize(keepCount);
+  lap(&mLastStepTimes.explosions);
 
-  mObjects.splice(mObjects.end(), totalEjecta);
+  int chunkCount = updateObjects(deltaTime, context);
+  lap(&mLastStepTimes.update);
+
+  mLastStepCounts.ejecta = mEjecta.size();
+  for (auto &obj : mEjecta)
+  {
+    countIn(*obj);
+    attachObject(obj);
+  }
+  mObjectSlots.resize(mObjects.size(), ObjectHandle::kNullSlot);
+  mEjecta.clear();
+  lap(&mLastStepTimes.explosions);
 
   checkForCollisions(&context);
+  lap(&mLastStepTimes.collisions);
 
-  for (auto obj : context.spawnList)
+  // Merge the spawns in chunk order, which is object order, so the
+  // result doesn't depend on how many threads did the update.
+  for (int chunk = 0; chunk < chunkCount; chunk++)
   {
-    mObjects.push_back(obj);
+    auto &spawnList = mChunkContexts[chunk].spawnList;
+    mLastStepCounts.spawns += spawnList.size();
+    for (auto &obj : spawnList)
+    {
+      countIn(*obj);
+      attachObject(obj);
+    }
+    spawnList.clear();
   }
+  mObjectSlots.resize(mObjects.size(), ObjectHandle::kNullSlot);
+  lap(&mLastStepTimes.spawnMerge);
 
-  mLastUpdateTimeValid = true;
-  mLastUpdateTime = currentTime;
+  mFramePoolAllocations = getPoolStats().heapAllocations - heapAllocationsBefore;
+  if (mStatsEnabled)
+  {
+    mFrameStats.steps++;
+    mFrameStats.stepTimes.add(mLastStepTimes);
+    mFrameStats.stepCounts.add(mLastStepCounts);
+  }
 }
 
-void GameBox::add(std::shared_ptr<GraphObj> obj)
+int GameBox::updateObjects(sf::Time deltaTime, const GraphObj::UpdateContext &context)
 {
-  if (obj)
+  size_t objectCount = mObjects.size();
+  int chunkCount = (int)((objectCount + kUpdateChunkSize - 1) / kUpdateChunkSize);
+  if ((int)mChunkContexts.size() < chunkCount)
   {
-    mObjects.push_back(obj);
+    mChunkContexts.resize(chunkCount);
   }
-}
 
-void GameBox::remove(std::shared_ptr<GraphObj> obj)
-{
-  if (obj)
+  if (mBatchedMotion && (int)mChunkMotion.size() < chunkCount)
   {
-    for (std::list<std::shared_ptr<GraphObj>>::iterator nextObj = mObjects.begin();
-      nextObj != mObjects.end(); 
-      ++nextObj)
+    mChunkMotion.resize(chunkCount);
+  }
+
+  auto updateChunk = [&](int chunk)
+  {
+    GraphObj::UpdateContext &chunkContext = mChunkContexts[chunk];
+    chunkContext.spaceLimits = context.spaceLimits;
+    chunkContext.random = context.random;
+    uint32_t first = (uint32_t)(chunk * kUpdateChunkSize);
+    uint32_t end = (uint32_t)std::min(objectCount, (chunk + 1) * kUpdateChunkSize);
+    float deltaSeconds = deltaTime.asSeconds();
+    sf::Vector2f limits((float)context.spaceLimits.x, (float)context.spaceLimits.y);
+    if (!mBatchedMotion)
+    {
+      // Passive objects are moved in their rows, and only looked at if
+      // they leave the space.  The rest update themselves.
+      for (uint32_t row = first; row < end; row++)
+      {
+        if (!mEntities.passive[row])
+        {
+          dispatch(mStaticDispatch, *mObjects[row], [&](auto &obj) { obj.update(deltaTime, &chunkContext); });
+        }
+        else if (mEntities.advance(row, deltaSeconds, limits))
+        {
+          mObjects[row]->onOutOfBounds(&chunkContext);
+        }
+      }
+      return;
+    }
+
+    // The passive rows are moved together first; then, in order, the
+    // rest update themselves and the passive objects that left the
+    // space wrap, just as the loop above has it.
+    MotionBatch &motion = mChunkMotion[chunk];
+    motion.integrate(&mEntities, first, end, deltaSeconds, limits);
+    for (uint32_t row = first; row < end; row++)
     {
-      if (obj == *nextObj)
+      if (!mEntities.passive[row])
+      {
+        dispatch(mStaticDispatch, *mObjects[row], [&](auto &obj) { obj.update(deltaTime, &chunkContext); });
+      }
+      else if (motion.isOutOfBounds(row))
       {
-        mObjects.erase(nextObj);
-        break;
+        mObjects[row]->onOutOfBounds(&chunkContext);
       }
     }
+  };
+
+  if (mThreadPool && objectCount >= kMinParallelObjects)
+  {
+    mThreadPool->run(chunkCount, updateChunk);
+  }
+  else
+  {
+    for (int chunk = 0; chunk < chunkCount; chunk++)
+    {
+      updateChunk(chunk);
+    }
+  }
+  return chunkCount;
+}
+
+void GameBox::setUpdateThreads(int threadCount)
+{
+  if (threadCount == 1)
+  {
+    mThreadPool.reset();
+  }
+  else
+  {
+    mThreadPool.reset(new ThreadPool(threadCount));
+  }
+}
+
+void GameBox::render(sf::RenderTarget &target, float interpolation)
+{
+  mRenderBatch.clear();
+  for (auto &obj : mObjects)
+  {
+    if (obj)
+    {
+      dispatch(mStaticDispatch, *obj, [&](auto &shown) { shown.render(mRenderBatch, interpolation); });
+    }
+  }
+  mParticles.render(mRenderBatch, interpolation);
+  mRenderBatch.draw(target);
+}
+
+ObjectHandle GameBox::add(std::shared_ptr<GraphObj> obj)
+{
+  ObjectHandle handle;
+  if (obj)
+  {
+    handle = mHandles.acquire((uint32_t)mObjects.size());
+    countIn(*obj);
+    attachObject(obj);
+    mObjectSlots.push_back(handle.slot);
   }
+  return handle;
 }
 
-bool GameBox::isPresent(std::shared_ptr<GraphObj> obj)
+void GameBox::remove(ObjectHandle handle)
 {
-  for (auto &nextObj : mObjects)
+  if (mHandles.isValid(handle))
+  {
+    // Leave a gap for the next step to close, rather than shifting
+    // everything after it down now.
+    uint32_t position = mHandles.getPosition(handle.slot);
+    countOut(*mObjects[position]);
+    mObjects[position]->detach();
+    mObjects[position].reset();
+    mObjectSlots[position] = ObjectHandle::kNullSlot;
+    mHandles.release(handle.slot);
+  }
+}
+
+void GameBox::queryRadius(sf::Vector2f center, float radius, sf::Vector2u spaceLimits,
+                          std::vector<GraphObj *> *found, int team) const
+{
+  if (found == nullptr || radius <= 0)
+  {
+    return;
+  }
+
+  // Objects wrap round the edges of space whatever collisions do, so
+  // the query always wraps.
+  sf::Vector2f wrapSpan((float)spaceLimits.x, (float)spaceLimits.y);
+  float radiusSq = radius * radius;
+  auto consider = [&](GraphObj *obj)
   {
-    if (nextObj == obj)
+    if (obj == nullptr || (team != kAnyTeam && obj->getTeam() != team))
     {
-      return true;
+      return;
+    }
+    sf::Vector2f position = obj->getPosition();
+    float deltaX = CollisionKernel::wrapDelta(position.x - center.x, wrapSpan.x);
+    float deltaY = CollisionKernel::wrapDelta(position.y - center.y, wrapSpan.y);
+    if (deltaX * deltaX + deltaY * deltaY < radiusSq)
+    {
+      found->push_back(obj);
+    }
+  };
+
+  if (!mQueryIndexValid || spaceLimits != mQueryIndexLimits)
+  {
+    for (auto &obj : mObjects)
+    {
+      consider(obj.get());
+    }
+    return;
+  }
+
+  // An object's envelope holds its center, so the grids find every
+  // candidate that could be in range.  Objects removed since the grids
+  // were built have left gaps, which consider skips.
+  CollisionEnvelope area(center, radius);
+  for (size_t index = 0; index < mLayerCount; index++)
+  {
+    const CollisionLayer &layer = mLayers[index];
+    if (team != kAnyTeam && layer.team != team)
+    {
+      continue;
+    }
+    // Searching as a team the layer isn't on leaves none of it out
+    mQueryIndices.clear();
+    layer.grid.findNear(area, ~layer.team, wrapSpan, &mQueryIndices);
+    for (int member : mQueryIndices)
+    {
+      consider(mObjects[mCollidePositions[layer.members[member]]].get());
     }
   }
-  return false;
-}
\ No newline at end of file
+  for (uint32_t position : mUnindexedPositions)
+  {
+    consider(mObjects[position].get());
+  }
+  for (size_t position = mIndexEnd; position < mObjects.size(); position++)
+  {
+    consider(mObjects[position].get());
+  }
+}
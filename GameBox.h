@@ -9,28 +9,337 @@
 
 #include <memory>
 #include <list>
+#include <vector>
 #include "GraphObj.h"
+#include "CollisionGrid.h"
+#include "CollisionMatrix.h"
+#include "EntityStore.h"
+#include "SweepAndPrune.h"
+#include "HandleTable.h"
+#include "MotionBatch.h"
+#include "ParticleSystem.h"
+#include "RenderBatch.h"
+#include "ThreadPool.h"
 
 class GameBox
 {
 public:
+
+  enum class CollisionMode
+  {
+    BruteForce,    // Test every pair of objects
+    SpatialHash,   // Only test objects in neighboring grid cells
+    SweepAndPrune  // Only test objects whose sorted bounds overlap
+  };
+
   GameBox() {}
-  virtual ~GameBox() {}
+  virtual ~GameBox();
+
+  // Steps the game by the time since the last update, using the
+  // target's size as the limits of space, then draws it.  With a fixed
+  // timestep, the elapsed time is run as whole ticks and the drawing is
+  // interpolated between the last two ticks.
+  virtual void update(sf::RenderTarget &target);
+
+  // Switches update to fixed ticks of 1 / ticksPerSecond.  At most
+  // maxCatchUpSteps ticks run per update; time beyond that (after a
+  // stall) is dropped rather than run all at once.
+  void setFixedTimestep(int ticksPerSecond, int maxCatchUpSteps);
+
+  // Goes back to stepping by the raw time between updates.
+  void setVariableTimestep() { mFixedTimestep = false; }
+
+  // Advances the game by deltaTime without drawing anything.  This is
+  // all a headless game (a server, a bot or a benchmark) needs.
+  void step(sf::Time deltaTime, sf::Vector2u spaceLimits);
+
+  // Draws every object in a single batch, placed at the given fraction
+  // of the way through the last step.
+  void render(sf::RenderTarget &target, float interpolation = 1);
+
+  // Adds an object, returning a handle to it that stays valid until
+  // the object leaves the box, by removal or by dying.
+  ObjectHandle add(std::shared_ptr<GraphObj> obj);
+
+  // Takes the object out of the box at once.  It's dropped from the
+  // object list, without exploding, at the start of the next step.
+  void remove(ObjectHandle handle);
+
+  bool isPresent(ObjectHandle handle) const { return mHandles.isValid(handle); }
+
+  // The object, or null once it has left the box.
+  GraphObj *getObject(ObjectHandle handle) const
+  {
+    return mHandles.isValid(handle) ? mObjects[mHandles.getPosition(handle.slot)].get() : nullptr;
+  }
+
+  // The number of objects in the box: in all, on a team, and of a type.
+  // These are kept up to date as objects come and go, so asking costs
+  // nothing.  An object counts until the step that clears it out, as
+  // isPresent does, and is counted on the team it had when it came in.
+  size_t getObjectCount() const { return mObjectCount; }
+  size_t getTeamCount(int team) const
+  {
+    return team >= 0 && team < (int)mTeamCounts.size() ? mTeamCounts[team] : 0;
+  }
+  size_t getTypeCount(ObjectType type) const { return mTypeCounts[(int)type]; }
+
+  // Stands for every team in a query
+  static const int kAnyTeam = -1;
+
+  // Appends the objects whose centers lie within radius of the point,
+  // measured the short way round the wrapping space, keeping only those
+  // on the given team unless it's kAnyTeam.  The last step's collision
+  // grids serve the query, so it costs about the number of objects near
+  // the point; without current grids every object is looked at.  The
+  // pointers are good until the next step.
+  void queryRadius(sf::Vector2f center, float radius, sf::Vector2u spaceLimits,
+                   std::vector<GraphObj *> *found, int team = kAnyTeam) const;
+
+  // The number of pooled objects that had to be allocated from the heap
+  // during the last update.  Zero once the pools have warmed up.
+  uint64_t getFramePoolAllocations() const { return mFramePoolAllocations; }
+
+  // How long each phase of a step took.  Only timed while stats are
+  // enabled.
+  struct StepTimes
+  {
+    sf::Time particles;  // Moving the particles
+    sf::Time explosions; // Clearing out the dead, and adding what they threw out
+    sf::Time update;     // Updating the objects
+    sf::Time collisions; // Finding and applying the collisions
+    sf::Time spawnMerge; // Adding the objects the update spawned
+
+    void add(const StepTimes &other);
+  };
+  const StepTimes &getLastStepTimes() const { return mLastStepTimes; }
+
+  // What a step did.  Always counted, since it costs next to nothing.
+  struct StepCounts
+  {
+    size_t explosions = 0;     // Dead objects that exploded
+    size_t ejecta = 0;         // Objects they threw out
+    size_t collisionTests = 0; // Pairs put through the narrowphase
+    size_t collisions = 0;     // Pairs that collided
+    size_t spawns = 0;         // Objects spawned by the update
+
+    void add(const StepCounts &other);
+  };
+  const StepCounts &getLastStepCounts() const { return mLastStepCounts; }
+
+  // Everything the last update did: its steps added together, its
+  // drawing, and what was in play at the end of it.
+  struct FrameStats
+  {
+    int steps = 0;
+    StepTimes stepTimes;
+    StepCounts stepCounts;
+    sf::Time render;
+    size_t objects = 0;
+    size_t objectsByType[kObjectTypeCount] = {};
+    size_t particles = 0;
+  };
+
+  // Times each phase of the steps and the drawing, and counts the
+  // objects in play, for getFrameStats.  Off by default; while off, the
+  // step counts are all that's kept.
+  void setStatsEnabled(bool enabled)
+  {
+    mStatsRequested = enabled;
+    mStatsEnabled = mStatsRequested || mStatsOverlay;
+  }
+  bool getStatsEnabled() const { return mStatsEnabled; }
+  const FrameStats &getFrameStats() const { return mFrameStats; }
+
+  // Draws a graph of the recent frames over the game, each a column split
+  // by phase, against a line at a 60 Hz frame.  Keeps the stats on while
+  // it is shown.
+  void setStatsOverlay(bool enabled);
+  bool getStatsOverlay() const { return mStatsOverlay; }
+
+  // Spreads the object updates over a pool of threads.  Zero uses one
+  // thread per core; one updates everything on the calling thread.
+  void setUpdateThreads(int threadCount);
+
+  // Moves passive objects (see GraphObj::isPassive) in batches rather
+  // than one row at a time.  The results are the same either way.  On by
+  // default, as it nearly halves the update time in GameBoxBench.
+  void setBatchedMotion(bool enabled) { mBatchedMotion = enabled; }
+
+  // The fragments thrown out by explosions.  Set its capacity to bound
+  // how many can be on screen at once.
+  ParticleSystem &getParticles() { return mParticles; }
 
-  virtual void update(sf::RenderWindow &win);
+  // The game's random number generator.  Seed it to replay a game.
+  Random &getRandom() { return mRandom; }
 
-  void add(std::shared_ptr<GraphObj> obj);
-  void remove(std::shared_ptr<GraphObj> obj);
-  bool isPresent(std::shared_ptr<GraphObj> obj);
+  // Tests objects with an outline (see GraphObj::getCollisionOutline)
+  // against the outline itself, once the circles round their farthest
+  // points meet, rather than against their collision circle.  Off by
+  // default, which keeps the game as it has always played.
+  void setPolygonCollisions(bool enabled) { mPolygonCollisions = enabled; }
+  bool getPolygonCollisions() const { return mPolygonCollisions; }
+
+  // With static dispatch, the hot paths call each object as its final
+  // type (see ObjectDispatch.h), so updating, drawing and testing
+  // collisions make direct calls instead of virtual ones.  On by
+  // default; turning it off is only useful to measure the difference.
+  void setStaticDispatch(bool enabled) { mStaticDispatch = enabled; }
+  bool getStaticDispatch() const { return mStaticDispatch; }
+
+  // The rules for which teams and types of object may collide.  The
+  // collision search skips every group of objects the matrix rules out,
+  // without looking at its pairs.
+  void setCollisionMatrix(const CollisionMatrix &matrix) { mCollisionMatrix = matrix; }
+  const CollisionMatrix &getCollisionMatrix() const { return mCollisionMatrix; }
+
+  void setCollisionMode(CollisionMode mode) { mCollisionMode = mode; }
+  CollisionMode getCollisionMode() const { return mCollisionMode; }
 
 protected:
 
+  // Updates every object, chunk by chunk, returning the number of chunks.
+  // Each chunk posts its spawns to its own entry of mChunkContexts.
+  int updateObjects(sf::Time deltaTime, const GraphObj::UpdateContext &context);
+
   void checkForCollisions(GraphObj::UpdateContext *context);
+  void checkForCollisionsBruteForce(GraphObj::UpdateContext *context);
+
+  // Tests the broadphase candidate pairs (in parallel when there are
+  // threads), then applies the hits in the same order the brute force
+  // search would have found them.
+  void resolveCollisionPairs(GraphObj::UpdateContext *context);
+
+  // Keep the population counts as objects come into and leave the box.
+  void countIn(const GraphObj &obj);
+  void countOut(const GraphObj &obj);
+
+  // Fills in the object counts of the frame stats.
+  void countObjects();
+
+  // Adds the last frame to the overlay's history, and draws it.
+  void drawStatsOverlay(sf::RenderTarget &target);
+
+  // The narrowphase test for a pair of collision candidates.  Changes
+  // nothing, so it's safe to call from several threads at once.
+  bool pairCollides(size_t first, size_t second, GraphObj::UpdateContext *context, sf::Vector2f wrapSpan) const;
+
+  // The collision candidates on one team and of one type, with a grid
+  // of their envelopes in SpatialHash mode.
+  struct CollisionLayer
+  {
+    int team = 0;
+    ObjectType type = ObjectType::Other;
+    std::vector<int> members; // Candidate indices, in order
+    std::vector<CollisionEnvelope> envelopes;
+    std::vector<int> teams;
+    CollisionGrid grid;
+  };
+
+  // Sorts the collision candidates into layers, and works out from the
+  // collision matrix which pairs of layers may collide.
+  void buildCollisionLayers();
+
+  bool layersCollide(size_t first, size_t second) const
+  {
+    return mLayerPairs[mCandidateLayer[first] * mLayerCount + mCandidateLayer[second]] != 0;
+  }
+
+  // Grids each layer, and finds the overlapping pairs between the
+  // layers that may collide.
+  void findLayerOverlaps(sf::Vector2u spaceLimits);
 
-  std::list<std::shared_ptr<GraphObj>> mObjects;
+  // Tells a collision candidate it has been hit.
+  void notifyCollision(size_t candidate);
+
+  // The exact test for a pair where at least one has an outline.
+  bool outlinesCollide(size_t first, size_t second, sf::Vector2f wrapSpan) const;
+
+  // Null where an object has been removed since the last step
+  std::vector<std::shared_ptr<GraphObj>> mObjects;
+
+  // The moving state of the objects, a row for each, kept in step with
+  // mObjects.  The row of a removed object is left until the next step
+  // packs the rows down.
+  EntityStore mEntities;
+  std::vector<EntityStore::RowRun> mRowRuns; // Reused by each step's packing
+
+  // Moves an object's state into the store as it joins the end of
+  // mObjects.
+  void attachObject(const std::shared_ptr<GraphObj> &obj);
+
+  // The handle slot of each object, kept in step with mObjects.  Only
+  // objects given to add() have one; the rest are kNullSlot.
+  std::vector<uint32_t> mObjectSlots;
+  HandleTable mHandles;
+
+  size_t mObjectCount = 0;
+  std::vector<size_t> mTeamCounts; // By team, for teams from zero up
+  size_t mTypeCounts[kObjectTypeCount] = {};
+  Random mRandom;
+  RenderBatch mRenderBatch;
+  ParticleSystem mParticles;
   sf::Time mLastUpdateTime;
   sf::Clock mClock;
   bool mLastUpdateTimeValid = false;
+
+  bool mFixedTimestep = false;
+  sf::Time mTickTime;
+  sf::Time mTickAccumulator;
+  int mMaxCatchUpSteps = 1;
+  uint64_t mFramePoolAllocations = 0;
+  StepTimes mLastStepTimes;
+  StepCounts mLastStepCounts;
+  FrameStats mFrameStats;
+  bool mStatsRequested = false; // As set by setStatsEnabled
+  bool mStatsEnabled = false;   // Requested, or needed by the overlay
+  bool mStatsOverlay = false;
+  std::vector<FrameStats> mOverlayFrames; // A ring of the recent frames
+  size_t mOverlayNext = 0;
+  RenderBatch mOverlayBatch;
+
+  // Reused each update, to keep their capacity.
+  std::vector<std::shared_ptr<GraphObj>> mEjecta;
+  std::vector<GraphObj::UpdateContext> mChunkContexts;
+  std::vector<MotionBatch> mChunkMotion;
+  bool mBatchedMotion = true;
+
+  std::unique_ptr<ThreadPool> mThreadPool;
+
+  CollisionMode mCollisionMode = CollisionMode::SpatialHash;
+  bool mPolygonCollisions = false;
+  bool mStaticDispatch = true;
+  CollisionMatrix mCollisionMatrix;
+  SweepAndPrune mSweepAndPrune;
+
+  // Scratch space for the collision pass, kept to reuse its capacity.
+  std::vector<GraphObj *> mCollideCandidates;
+  std::vector<CollisionEnvelope> mCollideEnvelopes;
+  std::vector<int> mCollideTeams;
+  std::vector<uint8_t> mCollideFast;
+  std::vector<sf::Vector2f> mOutlinePoints; // Turned and scaled, about the center
+  std::vector<int> mOutlineFirst;           // Per candidate, into mOutlinePoints
+  std::vector<int> mOutlineCount;           // Per candidate, zero for none
+  std::vector<float> mOutlineInner;         // Per candidate, the scaled inner radius
+  std::vector<std::pair<int, int>> mCollidePairs;
+  std::vector<uint8_t> mPairHits;
+  std::vector<bool> mCollided;
+  std::vector<CollisionLayer> mLayers; // Only the first mLayerCount are in use
+  size_t mLayerCount = 0;
+  std::vector<int> mCandidateLayer;
+  std::vector<uint8_t> mLayerPairs;    // Whether each pair of layers may collide
+  std::vector<int> mNearIndices;
+
+  // The radius query index: whether the layer grids hold the objects
+  // where they are now, the position in mObjects of each candidate in
+  // them, and the objects they leave out - those that can't collide, and
+  // from mIndexEnd on, those that came in after they were built.
+  bool mQueryIndexValid = false;
+  sf::Vector2u mQueryIndexLimits;
+  std::vector<uint32_t> mCollidePositions;
+  std::vector<uint32_t> mUnindexedPositions;
+  size_t mIndexEnd = 0;
+  mutable std::vector<int> mQueryIndices;
 };
 
 #endif
\ No newline at end of file
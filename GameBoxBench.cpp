@@ -0,0 +1,234 @@
+/**
+ * @file GameBoxBench.cpp
+ *
+ * Times whole game steps on fixed scenes of increasing size.  Each scene
+ * is an asteroid field, built as populateField builds one, with a few
+ * ships on another team spinning and firing into it, so every phase of
+ * the step has work to do: bolts hit rocks, rocks explode, and pieces
+ * are spawned.  Each ship starts in a space cleared in the field, as the
+ * player's does, and a ship that dies is replaced before the next tick,
+ * so the firing keeps up for the whole run.  The space grows with the
+ * scene to keep the crowding the same.
+ *
+ * Every scene comes from a fixed seed, and the count of objects left at
+ * the end is printed, so runs can be compared across changes.  The
+ * phase times and the counts of collision tests and spawns come from
+ * GameBox's stats.  Heap allocations are counted by replacing the global
+ * operator new.
+ *
+ * Each scene runs twice: once with the objects called through their
+ * vtables, as they always used to be, and once with GameBox's static
+ * dispatch, which calls each as its final type.
+ *
+ * Usage: GameBoxBench [ticks] [threads] [objects...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "AsteroidField.h"
+#include "ObjectPool.h"
+#include "Ship.h"
+
+static const int kDefaultTicks = 100;
+static const int kWarmUpTicks = 10;
+static const int kDefaultSizes[] = { 100, 1000, 10000, 100000 };
+static const int kTicksPerSecond = 100;
+static const unsigned int kBaseWidth = 1920;
+static const unsigned int kBaseHeight = 1080;
+static const int kBaseObjects = 1000;   // The scene that fills the base space
+static const int kObjectsPerShip = 200;
+static const int kMaxShips = 100;
+static const int kShipTeamIndex = 0;
+static const float kShipRadius = 20;
+static const float kClearRadius = 5 * kShipRadius; // Cleared round each new ship
+static const uint64_t kSeed = 1;
+
+static std::atomic<uint64_t> gAllocations(0);
+
+void *operator new(size_t size)
+{
+  gAllocations++;
+  void *memory = malloc(size > 0 ? size : 1);
+  if (memory == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+  free(memory);
+}
+
+// The running totals for one scene, in milliseconds, and the total
+// pairs put through the collision narrowphase.
+struct PhaseTotals
+{
+  double particles = 0;
+  double explosions = 0;
+  double update = 0;
+  double collisions = 0;
+  double spawnMerge = 0;
+  double step = 0;
+  double collisionTests = 0;
+  double spawns = 0;
+
+  void add(const GameBox::StepTimes &times, const GameBox::StepCounts &counts, double stepTime)
+  {
+    particles += times.particles.asMicroseconds() / 1000.0;
+    explosions += times.explosions.asMicroseconds() / 1000.0;
+    update += times.update.asMicroseconds() / 1000.0;
+    collisions += times.collisions.asMicroseconds() / 1000.0;
+    spawnMerge += times.spawnMerge.asMicroseconds() / 1000.0;
+    step += stepTime;
+    collisionTests += counts.collisionTests;
+    spawns += counts.spawns;
+  }
+};
+
+static sf::Vector2u getSpaceSize(int objectCount)
+{
+  float scale = sqrt((float)objectCount / kBaseObjects);
+  return sf::Vector2u((unsigned int)(kBaseWidth * scale), (unsigned int)(kBaseHeight * scale));
+}
+
+// Adds a ship somewhere random, clearing the rocks round it first.
+static ObjectHandle spawnShip(AsteroidField *field, sf::Vector2u spaceSize)
+{
+  Ship::Config shipConfig;
+  shipConfig.baseColor = sf::Color::Green;
+  shipConfig.sizeRadius = kShipRadius;
+  shipConfig.headToHead = false;
+  Ship::Controls controls;
+  controls.rotateLeft = true;
+  controls.fire = true;
+
+  Random &random = field->getRandom();
+  auto ship = std::make_shared<Ship>(shipConfig);
+  ship->setPosition(sf::Vector2f(random.randFloat(0, (float)spaceSize.x), random.randFloat(0, (float)spaceSize.y)));
+  ship->setOrientation(random.randFloat(0, 2 * PI));
+  ship->setTeam(kShipTeamIndex);
+  ship->updateControls(controls);
+  field->disintegrateAround(ship->getPosition(), kClearRadius, spaceSize);
+  return field->add(ship);
+}
+
+// Replaces the ships that have died.
+static void respawnShips(AsteroidField *field, std::vector<ObjectHandle> *ships, sf::Vector2u spaceSize)
+{
+  for (auto &ship : *ships)
+  {
+    if (!field->isPresent(ship))
+    {
+      ship = spawnShip(field, spaceSize);
+    }
+  }
+}
+
+static void buildScene(AsteroidField *field, int objectCount, sf::Vector2u spaceSize, std::vector<ObjectHandle> *ships)
+{
+  field->getRandom().seed(kSeed);
+
+  AsteroidField::FieldConfig fieldConfig;
+  fieldConfig.minAsteroids = objectCount;
+  fieldConfig.maxAsteroids = objectCount;
+  fieldConfig.maxLinearSpeed = 100;
+  fieldConfig.maxRadialSpeed = 2 * PI;
+  fieldConfig.minAsteroidSize = 10;
+  fieldConfig.maxAsteroidSize = 30;
+  field->populateField(fieldConfig, spaceSize);
+
+  int shipCount = std::min(std::max(objectCount / kObjectsPerShip, 1), kMaxShips);
+  ships->assign(shipCount, ObjectHandle());
+  respawnShips(field, ships, spaceSize);
+}
+
+static void runScene(int objectCount, int ticks, int threads, bool staticDispatch)
+{
+  sf::Vector2u spaceSize = getSpaceSize(objectCount);
+  sf::Time tickTime = sf::seconds(1.0F / kTicksPerSecond);
+
+  AsteroidField field;
+  field.setUpdateThreads(threads);
+  field.setStatsEnabled(true);
+  field.setStaticDispatch(staticDispatch);
+  auto buildStart = std::chrono::steady_clock::now();
+  std::vector<ObjectHandle> ships;
+  buildScene(&field, objectCount, spaceSize, &ships);
+  std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - buildStart;
+
+  for (int tick = 0; tick < kWarmUpTicks; tick++)
+  {
+    respawnShips(&field, &ships, spaceSize);
+    field.step(tickTime, spaceSize);
+  }
+
+  // Only the steps are timed, and only their allocations counted; the
+  // new ships are left out of both.
+  PhaseTotals totals;
+  uint64_t allocations = 0;
+  uint64_t poolAllocations = 0;
+  for (int tick = 0; tick < ticks; tick++)
+  {
+    respawnShips(&field, &ships, spaceSize);
+    uint64_t allocationsBefore = gAllocations;
+    uint64_t poolAllocationsBefore = getPoolStats().heapAllocations;
+    auto stepStart = std::chrono::steady_clock::now();
+    field.step(tickTime, spaceSize);
+    std::chrono::duration<double, std::milli> stepTime = std::chrono::steady_clock::now() - stepStart;
+    allocations += gAllocations - allocationsBefore;
+    poolAllocations += getPoolStats().heapAllocations - poolAllocationsBefore;
+    totals.add(field.getLastStepTimes(), field.getLastStepCounts(), stepTime.count());
+  }
+
+  printf("%7d %7s %5ux%-5u %8.1f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f %10.1f %8.1f %10.1f %9.1f %8d\n",
+         objectCount, staticDispatch ? "static" : "virtual", spaceSize.x, spaceSize.y, buildTime.count(),
+         totals.step / ticks, totals.particles / ticks, totals.explosions / ticks,
+         totals.update / ticks, totals.collisions / ticks, totals.spawnMerge / ticks,
+         totals.collisionTests / ticks, totals.spawns / ticks, (double)allocations / ticks, (double)poolAllocations / ticks,
+         field.getAsteroidTeamCount());
+}
+
+int main(int argc, char *argv[])
+{
+  int ticks = argc > 1 ? atoi(argv[1]) : kDefaultTicks;
+  int threads = argc > 2 ? atoi(argv[2]) : 1;
+  std::vector<int> sizes;
+  for (int arg = 3; arg < argc; arg++)
+  {
+    sizes.push_back(atoi(argv[arg]));
+  }
+  if (sizes.empty())
+  {
+    sizes.assign(std::begin(kDefaultSizes), std::end(kDefaultSizes));
+  }
+  if (ticks <= 0)
+  {
+    ticks = kDefaultTicks;
+  }
+
+  printf("%d ticks after %d to warm up, %d update thread%s; times are ms per tick\n",
+         ticks, kWarmUpTicks, threads, threads == 1 ? "" : "s");
+  printf("%7s %7s %11s %8s %9s %9s %9s %9s %9s %9s %10s %8s %10s %9s %8s\n",
+         "objects", "calls", "space", "build", "step", "particle", "explode", "update", "collide", "spawn",
+         "tests", "spawns", "allocs", "pool", "left");
+  for (int objectCount : sizes)
+  {
+    runScene(objectCount, ticks, threads, false);
+    runScene(objectCount, ticks, threads, true);
+  }
+  return 0;
+}
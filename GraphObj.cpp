@@ -7,110 +7,388 @@
  */
 
 #include "GraphObj.h"
+#include "RenderBatch.h"
 
 #include <SFML/Graphics.hpp>
 
-void GraphObj::changeModelToWorld(sf::VertexArray *va, AngleFactors angleFact)
+static sf::Vertex toWorld(const sf::Vertex &vertex, sf::Vector2f center, AngleFactors angleFact)
 {
-  if (va != nullptr)
+  sf::Vector2f pt = vertex.position;
+  return sf::Vertex(
+    center + sf::Vector2f(pt.x * angleFact.cosFactor - pt.y * angleFact.sinFactor,
+                          pt.x * angleFact.sinFactor + pt.y * angleFact.cosFactor),
+    vertex.color);
+}
+
+void WorldGeometry::clear()
+{
+  triangles.clear();
+  lines.clear();
+  points.clear();
+}
+
+void WorldGeometry::addShape(const sf::VertexArray &shape, sf::Vector2f center, AngleFactors angleFact)
+{
+  size_t count = shape.getVertexCount();
+  switch (shape.getPrimitiveType())
   {
-    for (unsigned int index = 0; index < va->getVertexCount(); index++)
+  case sf::Triangles:
+    for (size_t index = 0; index + 2 < count; index += 3)
+    {
+      triangles.append(toWorld(shape[index], center, angleFact));
+      triangles.append(toWorld(shape[index + 1], center, angleFact));
+      triangles.append(toWorld(shape[index + 2], center, angleFact));
+    }
+    break;
+
+  case sf::Quads:
+    // Each quad splits into two triangles across its 0-2 diagonal
+    for (size_t index = 0; index + 3 < count; index += 4)
+    {
+      sf::Vertex corner0 = toWorld(shape[index], center, angleFact);
+      sf::Vertex corner2 = toWorld(shape[index + 2], center, angleFact);
+      triangles.append(corner0);
+      triangles.append(toWorld(shape[index + 1], center, angleFact));
+      triangles.append(corner2);
+      triangles.append(corner0);
+      triangles.append(corner2);
+      triangles.append(toWorld(shape[index + 3], center, angleFact));
+    }
+    break;
+
+  case sf::TriangleFan:
+    if (count >= 3)
+    {
+      sf::Vertex hub = toWorld(shape[0], center, angleFact);
+      sf::Vertex previous = toWorld(shape[1], center, angleFact);
+      for (size_t index = 2; index < count; index++)
+      {
+        sf::Vertex next = toWorld(shape[index], center, angleFact);
+        triangles.append(hub);
+        triangles.append(previous);
+        triangles.append(next);
+        previous = next;
+      }
+    }
+    break;
+
+  case sf::TriangleStrip:
+    for (size_t index = 0; index + 2 < count; index++)
+    {
+      triangles.append(toWorld(shape[index], center, angleFact));
+      triangles.append(toWorld(shape[index + 1], center, angleFact));
+      triangles.append(toWorld(shape[index + 2], center, angleFact));
+    }
+    break;
+
+  case sf::Lines:
+    for (size_t index = 0; index + 1 < count; index += 2)
+    {
+      lines.append(toWorld(shape[index], center, angleFact));
+      lines.append(toWorld(shape[index + 1], center, angleFact));
+    }
+    break;
+
+  case sf::LineStrip:
+    for (size_t index = 0; index + 1 < count; index++)
+    {
+      lines.append(toWorld(shape[index], center, angleFact));
+      lines.append(toWorld(shape[index + 1], center, angleFact));
+    }
+    break;
+
+  default:
+    for (size_t index = 0; index < count; index++)
     {
-      (*va)[index].position = modelToWorld((*va)[index].position, angleFact);
+      points.append(toWorld(shape[index], center, angleFact));
     }
+    break;
   }
 }
 
-void GraphObj::render(sf::RenderWindow &win)
+void GraphObj::placeShapes(WorldGeometry *geometry, sf::Vector2f center, AngleFactors angleFact) const
 {
-  AngleFactors angleFact(mAngleRadians);
   for (auto &shape : mModelShapes)
   {
     if (shape.isVisible)
     {
-      Shape worldShape = shape; 
-      changeModelToWorld(&worldShape.vertices, angleFact);
-      win.draw(worldShape.vertices);
+      geometry->addShape(shape.vertices, center, angleFact);
     }
   }
 }
 
+void GraphObj::render(RenderBatch &batch, float interpolation)
+{
+  // Back the pose up along the last update's motion
+  float behind = 1 - interpolation;
+  sf::Vector2f center = getPosition() - getLastMove() * behind;
+  float angle = getAngle() - getLastTurn() * behind;
+  placeShapes(batch.getGeometry(), center, AngleFactors(angle));
+}
+
 void GraphObj::onOutOfBounds(UpdateContext *context) 
 {
   if (context)
   {
-    if (mCenterPt.x < 0)
+    sf::Vector2f position = getPosition();
+    if (position.x < 0)
     {
-      mCenterPt.x += context->spaceLimits.x;
+      position.x += context->spaceLimits.x;
     }
-    else if (mCenterPt.x > context->spaceLimits.x)
+    else if (position.x > context->spaceLimits.x)
     {
-      mCenterPt.x -= context->spaceLimits.x;
+      position.x -= context->spaceLimits.x;
     }
-    if (mCenterPt.y < 0)
+    if (position.y < 0)
     {
-      mCenterPt.y += context->spaceLimits.y;
+      position.y += context->spaceLimits.y;
     }
-    else if (mCenterPt.y > context->spaceLimits.y)
+    else if (position.y > context->spaceLimits.y)
     {
-      mCenterPt.y -= context->spaceLimits.y;
+      position.y -= context->spaceLimits.y;
     }
+    setPosition(position);
   }
 }
 
 void GraphObj::update(sf::Time deltaT, UpdateContext *context)
 {
+  EntityState state = getState();
+
+  // Objects with no lifespan have an infinite life, which never runs down
+  if (state.life > 0)
+  {
+    state.life -= deltaT.asSeconds();
+  }
+  if (state.life <= 0)
+  {
+    state.life = 0;
+    state.alive = false;
+  }
+
+  bool outOfBounds = false;
   if (context)
   {
     float deltaSeconds = deltaT.asSeconds();
-    mCenterPt += mLinearVelocity * deltaSeconds;
-    mAngleRadians += mRadialVelocity * deltaSeconds;
-    if (mAngleRadians > 2 * PI)
+    state.lastMove = state.velocity * deltaSeconds;
+    state.position += state.lastMove;
+    state.lastTurn = state.radialVelocity * deltaSeconds;
+    state.angle += state.lastTurn;
+    if (state.angle > 2 * PI)
     {
-      mAngleRadians -= 2 * PI;
+      state.angle -= 2 * PI;
     }
-    if (mAngleRadians < -2 * PI)
+    if (state.angle < -2 * PI)
     {
-      mAngleRadians += 2 * PI;
+      state.angle += 2 * PI;
     }
 
-    if (mCenterPt.x < 0 ||
-        mCenterPt.x > context->spaceLimits.x ||
-        mCenterPt.y < 0 ||
-        mCenterPt.y > context->spaceLimits.y)
-    {
-      onOutOfBounds(context);
-    }
+    outOfBounds = state.position.x < 0 ||
+                  state.position.x > context->spaceLimits.x ||
+                  state.position.y < 0 ||
+                  state.position.y > context->spaceLimits.y;
+  }
+
+  setState(state);
+  if (outOfBounds)
+  {
+    onOutOfBounds(context);
   }
 }
 
+void GraphObj::setPosition(sf::Vector2f pos)
+{
+  if (mStore)
+  {
+    mStore->setPosition(row(), pos);
+  }
+  else
+  {
+    mState.position = pos;
+  }
+}
+
+void GraphObj::setOrientation(float angleRadians)
+{
+  if (mStore)
+  {
+    mStore->angle[row()] = angleRadians;
+  }
+  else
+  {
+    mState.angle = angleRadians;
+  }
+}
+
+void GraphObj::setLinearVelocity(sf::Vector2f linearVelocity)
+{
+  if (mStore)
+  {
+    mStore->setVelocity(row(), linearVelocity);
+  }
+  else
+  {
+    mState.velocity = linearVelocity;
+  }
+}
+
+void GraphObj::setRadialVelocity(float radialVelocity)
+{
+  if (mStore)
+  {
+    mStore->radialVelocity[row()] = radialVelocity;
+  }
+  else
+  {
+    mState.radialVelocity = radialVelocity;
+  }
+}
+
+void GraphObj::setTeam(int team)
+{
+  mTeam = team;
+  if (mStore)
+  {
+    mStore->team[row()] = team;
+  }
+}
+
+void GraphObj::setLifespan(float seconds)
+{
+  if (mStore)
+  {
+    mStore->life[row()] = seconds;
+  }
+  else
+  {
+    mState.life = seconds;
+  }
+}
+
+void GraphObj::setAlive(bool alive)
+{
+  if (mStore)
+  {
+    mStore->alive[row()] = alive ? 1 : 0;
+  }
+  else
+  {
+    mState.alive = alive;
+  }
+}
+
+void GraphObj::setState(const EntityState &state)
+{
+  if (mStore)
+  {
+    mStore->setState(row(), state);
+  }
+  else
+  {
+    mState = state;
+  }
+}
+
+void GraphObj::attach(EntityStore *store)
+{
+  assert(mStore == nullptr);
+  EntityTraits traits;
+  traits.radius = mCollisionRadius;
+  traits.boundingRadius = getBoundingRadius();
+  traits.team = mTeam;
+  traits.fast = mIsFast;
+  traits.passive = mIsPassive;
+  mEntity = store->add(mState, traits);
+  mStore = store;
+}
+
+void GraphObj::detach()
+{
+  if (mStore)
+  {
+    mState = mStore->getState(row());
+    mStore->release(mEntity);
+    mStore = nullptr;
+  }
+}
+
+
+CollisionEnvelope GraphObj::getSweptEnvelope(bool bounding) const
+{
+  CollisionEnvelope envelope = getCollisionEnvelope();
+  if (bounding)
+  {
+    envelope.radius = getBoundingRadius();
+  }
+  if (mIsFast)
+  {
+    sf::Vector2f lastMove = getLastMove();
+    float moveLength = sqrt(lastMove.x * lastMove.x + lastMove.y * lastMove.y);
+    envelope.center -= lastMove * 0.5F;
+    envelope.radius += moveLength * 0.5F;
+  }
+  return envelope;
+}
 
-// Inefficient
-// TODO: improve
 bool GraphObj::collidesWith(const GraphObj &obj, UpdateContext *context)
 {
   if (isAlive() && canCollide() && 
       obj.isAlive() && obj.canCollide() && 
       getTeam() != obj.getTeam())
   {
-    sf::Vector2f delta = mCenterPt - obj.mCenterPt;
+    sf::Vector2f delta = getPosition() - obj.getPosition();
+    sf::Vector2f wrapShift;
     if (context)
     {
 #ifdef WRAP_COLLISION
-      // Assume wrapping, in which case if we're over a half span away,
-      // we're closer to the wrapped distance.
-      if (delta.x > context->spaceLimits.x / 2)
+      // Assume wrapping, in which case if we're over a half span away
+      // (either way), we're closer to the wrapped distance.
+      float spanX = (float)context->spaceLimits.x;
+      float spanY = (float)context->spaceLimits.y;
+      if (delta.x > spanX / 2)
       {
-        delta.x -= context->spaceLimits.x;
+        wrapShift.x = -spanX;
       }
-      if (delta.y > context->spaceLimits.y / 2)
+      else if (delta.x < -spanX / 2)
       {
-        delta.y -= context->spaceLimits.y;
+        wrapShift.x = spanX;
+      }
+      if (delta.y > spanY / 2)
+      {
+        wrapShift.y = -spanY;
+      }
+      else if (delta.y < -spanY / 2)
+      {
+        wrapShift.y = spanY;
       }
 #endif
     }
-    float distanceSq = delta.x * delta.x + delta.y * delta.y;
+    delta += wrapShift;
     float minDistance = mCollisionRadius + obj.mCollisionRadius;
+
+    if (mIsFast || obj.mIsFast)
+    {
+      // Swept test: find the closest the two centers came over the
+      // last update, treating the relative motion as a straight line.
+      sf::Vector2f relativeMove = getLastMove() - obj.getLastMove();
+      sf::Vector2f startDelta = delta - relativeMove;
+      float moveLengthSq = relativeMove.x * relativeMove.x + relativeMove.y * relativeMove.y;
+      if (moveLengthSq > 0)
+      {
+        float t = -(startDelta.x * relativeMove.x + startDelta.y * relativeMove.y) / moveLengthSq;
+        if (t < 0)
+        {
+          t = 0;
+        }
+        else if (t > 1)
+        {
+          t = 1;
+        }
+        delta = startDelta + relativeMove * t;
+      }
+    }
+
+    float distanceSq = delta.x * delta.x + delta.y * delta.y;
     if (distanceSq < minDistance * minDistance)
     {
       return true;
@@ -119,30 +397,37 @@ bool GraphObj::collidesWith(const GraphObj &obj, UpdateContext *context)
   return false;
 }
 
-void GraphObj::knockRand(GraphObj::KnockConfig config)
+GraphObj::Knock GraphObj::randKnock(const KnockConfig &config, float mass, Random &random)
 {
-  float fragSpeed = 0;
-  float fragRadialSpeed = 0;
-  float angle = 0;
-
-  float knockLinearSpeed = randFloat(config.minLinearSpeed / mMass, config.maxLinearSpeed / mMass);
-  if (rand() % 2)
+  float knockLinearSpeed = random.randFloat(config.minLinearSpeed / mass, config.maxLinearSpeed / mass);
+  if (random.randBool())
   {
     knockLinearSpeed *= -1;
   }
-  float knockRadialSpeed = randFloat(config.minRadialSpeed / mMass, config.maxRadialSpeed / mMass);
-  float knockAngle = randFloat(0, 2 * PI);
+  float knockRadialSpeed = random.randFloat(config.minRadialSpeed / mass, config.maxRadialSpeed / mass);
+  float knockAngle = random.randFloat(0, 2 * PI);
 
   AngleFactors angleFactors(knockAngle);
   sf::Vector2f knockUnitVector(angleFactors.cosFactor, angleFactors.sinFactor);
 
-  mLinearVelocity += knockUnitVector * knockLinearSpeed;
-  mCenterPt += knockUnitVector * config.jumpDistance;
-  mRadialVelocity += knockRadialSpeed;
+  Knock knock;
+  knock.linearVelocity = knockUnitVector * knockLinearSpeed;
+  knock.jump = knockUnitVector * config.jumpDistance;
+  knock.radialVelocity = knockRadialSpeed;
+  knock.angle = knockAngle;
+  return knock;
+}
+
+void GraphObj::knockRand(GraphObj::KnockConfig config, Random &random)
+{
+  Knock knock = randKnock(config, mMass, random);
+  setLinearVelocity(getLinearVelocity() + knock.linearVelocity);
+  setPosition(getPosition() + knock.jump);
+  setRadialVelocity(getRadialVelocity() + knock.radialVelocity);
 
   if (config.forceOrientation)
   {
-    setOrientation(knockAngle);
+    setOrientation(knock.angle);
   }
 }
 
@@ -11,9 +11,12 @@
 
 #include <list>
 #include <memory>
+#include <vector>
 #include <SFML/Graphics.hpp>
 #include <stdlib.h>
 #include <assert.h>
+#include "EntityStore.h"
+#include "Random.h"
 
 struct CollisionEnvelope
 {
@@ -30,6 +33,29 @@ struct AngleFactors
   float cosFactor;
 };
 
+// Shapes placed in world space.  Filled shapes of every primitive type
+// (triangles, quads, fans and strips) are converted to a single triangle
+// list.  Lines and points, which can't be converted, get a list each.
+struct WorldGeometry
+{
+  WorldGeometry() : triangles(sf::Triangles), lines(sf::Lines), points(sf::Points) {}
+
+  // Empties the lists, keeping their capacity.
+  void clear();
+
+  // Appends a model-space shape, placed at the given center and angle.
+  void addShape(const sf::VertexArray &shape, sf::Vector2f center, AngleFactors angleFact);
+
+  size_t getVertexCount() const
+  {
+    return triangles.getVertexCount() + lines.getVertexCount() + points.getVertexCount();
+  }
+
+  sf::VertexArray triangles;
+  sf::VertexArray lines;
+  sf::VertexArray points;
+};
+
 #ifndef PI
 static const float PI = 3.1415927F;
 #endif
@@ -40,24 +66,23 @@ static const sf::Color kLightGray(224, 224, 224);
 static const sf::Color kMediumGray(0x80, 0x80, 0x80);
 static const sf::Color kDarkGray(0x60, 0x60, 0x60);
 
-static float randFloat()
+// The kinds of object, so they can be counted, and called (see
+// ObjectDispatch.h), without a virtual call.  Every kind but Other is a
+// final class that sets its own tag.
+enum class ObjectType
 {
-  return static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-}
+  Other,
+  Ship,
+  Asteroid,
+  Bolt,
+  Fragment,
+  Count
+};
 
-static int randInt(int min, int max)
-{
-  if (max > min)
-  {
-    return rand() % (max - min + 1) + min;
-  }
-  return min;
-}
+static const int kObjectTypeCount = (int)ObjectType::Count;
 
-static float randFloat(float min, float max)
-{
-  return min + randFloat() * (max - min);
-}
+class RenderBatch;
+class ParticleSystem;
 
 class GraphObj
 {
@@ -66,65 +91,122 @@ public:
   struct UpdateContext
   {
     sf::Vector2u spaceLimits; // Limits of the region of space
-    std::list<std::shared_ptr<GraphObj>> spawnList; // Allows an object to post new spawned objects
+    std::vector<std::shared_ptr<GraphObj>> spawnList; // Allows an object to post new spawned objects
+    Random *random = nullptr; // The game's random number generator - updates may run
+                              // on several threads at once, so not for use in update()
+    ParticleSystem *particles = nullptr; // Where explosions throw their fragments, if
+                                         // set - also not for use in update()
   };
 
   GraphObj() {}
   virtual ~GraphObj() {}
 
-  virtual void render(sf::RenderWindow &win);
+  // Adds the visible shapes, in world space, to the frame's batch.
+  // The interpolation places the object between where it was before the
+  // last update (0) and where it is now (1).
+  virtual void render(RenderBatch &batch, float interpolation);
 
   virtual void update(sf::Time deltaT, UpdateContext *context);
 
   // Returns true if this object should be in the game, false
   // if it is dead and should be cleared from the game.
-  bool isAlive() const { return mIsAlive; }
-  void kill() { mIsAlive = false; }
-  void revive() { mIsAlive = true; }
+  bool isAlive() const { return mStore ? mStore->alive[row()] != 0 : mState.alive; }
+  void kill() { setAlive(false); }
+  void revive() { setAlive(true); }
 
   // A version of kill that destroys without spawning children
   virtual void disintegrate() { kill(); }
 
-  virtual std::list<std::shared_ptr<GraphObj>> explode() { return std::list<std::shared_ptr<GraphObj>>(); }
+  // Appends the objects thrown out as this object dies to ejecta.
+  virtual void explode(std::vector<std::shared_ptr<GraphObj>> *ejecta, UpdateContext *context) {}
 
   virtual bool explodesOnDeath() const { return false; }
 
   virtual CollisionEnvelope getCollisionEnvelope() const
   {
-    return CollisionEnvelope(mCenterPt, mCollisionRadius);
+    return CollisionEnvelope(getPosition(), mCollisionRadius);
   }
 
+  // The envelope covering the whole path of a fast object over the last
+  // update, for use by the broadphase.  The same as the collision
+  // envelope for everything else.  With bounding set, the envelope is
+  // round the object's bounding radius instead of its collision radius.
+  CollisionEnvelope getSweptEnvelope(bool bounding = false) const;
+
   virtual bool collidesWith(const GraphObj &obj, UpdateContext *context);
 
+  // An outline for the polygon narrowphase: a closed ring of points in
+  // model space, drawn at the given scale.
+  struct CollisionOutline
+  {
+    const sf::Vector2f *points = nullptr;
+    int pointCount = 0;
+    float innerRadius = 0; // Of a circle about the center, inside the outline
+    float scale = 1;
+  };
+
+  // Objects with no outline collide as their circle.
+  virtual CollisionOutline getCollisionOutline() const { return CollisionOutline(); }
+
+  // The radius of the circle round the whole outline, which the
+  // broadphase uses when outlines are tested.  The same as the collision
+  // radius for objects with no outline.
+  float getBoundingRadius() const { return mBoundingRadius > 0 ? mBoundingRadius : mCollisionRadius; }
+
   virtual void onCollision()
   {
     kill();
   }
 
-  void setPosition(sf::Vector2f pos) { mCenterPt = pos; }
-  void setOrientation(float angleRadians) { mAngleRadians = angleRadians;  }
-  void setLinearVelocity(sf::Vector2f linearVelocity) { mLinearVelocity = linearVelocity; }
-  void setRadialVelocity(float radialVelocity) { mRadialVelocity = radialVelocity; }
-  void setTeam(int team) { mTeam = team; }
+  void setPosition(sf::Vector2f pos);
+  void setOrientation(float angleRadians);
+  void setLinearVelocity(sf::Vector2f linearVelocity);
+  void setRadialVelocity(float radialVelocity);
+  void setTeam(int team);
   void setMass(float mass) { mMass = mass; }
 
-  sf::Vector2f getPosition() const { return mCenterPt; }
-  sf::Vector2f getLinearVelocity() const { return mLinearVelocity; }
-  float getRadialVelocity() const { return mRadialVelocity; }
-  float getAngle() const { return mAngleRadians; }
+  sf::Vector2f getPosition() const { return mStore ? mStore->getPosition(row()) : mState.position; }
+  sf::Vector2f getLinearVelocity() const { return mStore ? mStore->getVelocity(row()) : mState.velocity; }
+  float getRadialVelocity() const { return mStore ? mStore->radialVelocity[row()] : mState.radialVelocity; }
+  float getAngle() const { return mStore ? mStore->angle[row()] : mState.angle; }
   float getMass() const { return mMass;  }
+  float getCollisionRadius() const { return mCollisionRadius; }
   
   sf::Vector2f getDirectionVector() const
   {
-    AngleFactors angleFactors(mAngleRadians);
+    AngleFactors angleFactors(getAngle());
     return sf::Vector2f(angleFactors.cosFactor, angleFactors.sinFactor);
   }
   int getTeam() const { return mTeam; }
+  ObjectType getType() const { return mType; }
 
   sf::Color getMainColor() { return mMainColor; }
 
   bool canCollide() const { return mCollisionRadius > 0; }
 
+  // Fast objects are tested along the path they moved in the last
+  // update, rather than only at their end point, so they can't pass
+  // through a small object between frames.
+  bool isFast() const { return mIsFast; }
+  sf::Vector2f getLastMove() const { return mStore ? mStore->getLastMove(row()) : mState.lastMove; }
+  float getLastTurn() const { return mStore ? mStore->lastTurn[row()] : mState.lastTurn; }
+
+  // Passive objects only drift: their update is exactly GraphObj::update,
+  // so the game box moves their rows all at once with a MotionBatch
+  // instead of calling update() on each.
+  bool isPassive() const { return mIsPassive; }
+
+  // An object with a lifespan dies once it has been updated for that long.
+  void setLifespan(float seconds);
+
+  // A game box keeps the moving state of the objects in it in its
+  // EntityStore.  attach moves this object's state into a new row at the
+  // end of the store, and the object reads and writes the row from then
+  // on; detach takes the state back.  Only the game box calls these.
+  void attach(EntityStore *store);
+  void detach();
+  bool isAttached() const { return mStore != nullptr; }
+
   struct KnockConfig
   {
     float minLinearSpeed = 0;
@@ -136,9 +218,20 @@ public:
   };
 
   // Hit the object with a random delta linear and radial velocity.
-  void knockRand(KnockConfig config);
+  void knockRand(KnockConfig config, Random &random);
+
+  // The random changes knockRand makes, for something of the given mass.
+  struct Knock
+  {
+    sf::Vector2f linearVelocity; // Added to the velocity
+    sf::Vector2f jump;           // Added to the position
+    float radialVelocity = 0;    // Added to the radial velocity
+    float angle = 0;             // The direction of the knock
+  };
+  static Knock randKnock(const KnockConfig &config, float mass, Random &random);
 
 protected:
+  friend class GameBox;
 
   struct Shape
   {
@@ -150,32 +243,49 @@ protected:
 
   sf::Vector2f modelToWorld(sf::Vector2f pt, AngleFactors angleFact) const
   {
-    return mCenterPt + sf::Vector2f(pt.x * angleFact.cosFactor - pt.y * angleFact.sinFactor, pt.x * angleFact.sinFactor + pt.y * angleFact.cosFactor);
+    return getPosition() + sf::Vector2f(pt.x * angleFact.cosFactor - pt.y * angleFact.sinFactor, pt.x * angleFact.sinFactor + pt.y * angleFact.cosFactor);
   }
   sf::Vector2f modelToWorld(sf::Vector2f pt) const
   {
-    AngleFactors angleFactors(mAngleRadians);
-    return mCenterPt + sf::Vector2f(pt.x * angleFactors.cosFactor - pt.y * angleFactors.sinFactor, pt.x * angleFactors.sinFactor + pt.y * angleFactors.cosFactor);
+    AngleFactors angleFactors(getAngle());
+    return getPosition() + sf::Vector2f(pt.x * angleFactors.cosFactor - pt.y * angleFactors.sinFactor, pt.x * angleFactors.sinFactor + pt.y * angleFactors.cosFactor);
   }
-  void changeModelToWorld(sf::VertexArray *va, AngleFactors angleFact);
 
   virtual void onOutOfBounds(UpdateContext *context);
 
-  sf::Vector2f mLinearVelocity;
-  float mRadialVelocity = 0;
+  // The whole moving state at once, from wherever it is kept.
+  EntityState getState() const { return mStore ? mStore->getState(row()) : mState; }
+  void setState(const EntityState &state);
+
+  void setAlive(bool alive);
+
+  // Appends the visible shapes, placed at the given pose.  The default
+  // places the model shapes; objects with shapes of their own override it.
+  virtual void placeShapes(WorldGeometry *geometry, sf::Vector2f center, AngleFactors angleFact) const;
 
   // This is relative to a 0,0 center point.
   std::vector<Shape> mModelShapes;
 
-  sf::Vector2f mCenterPt;
-  float mAngleRadians = 0;
+  // The moving state, kept here only while the object is in no store.
+  // Go through the accessors, which find it wherever it is.
+  EntityState mState;
+  EntityStore *mStore = nullptr;
+  uint32_t mEntity = 0; // The entity id of the object's row in mStore
+
+  // The object's row in the store.  Only while in one.
+  uint32_t row() const { return mStore->getRow(mEntity); }
+
   float mCollisionRadius = 0;
+  float mBoundingRadius = 0; // Set by objects with an outline
   float mMass = 1;
-  bool mIsAlive = true;
+  bool mIsFast = false;
+  bool mIsPassive = false;
   sf::Color mMainColor = kDarkGray;
 
   // Only objects on different teams are considered for collision.
   int mTeam = 0;
+
+  ObjectType mType = ObjectType::Other;
 };
 
 #endif
\ No newline at end of file
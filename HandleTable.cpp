@@ -0,0 +1,34 @@
+/**
+ * @file HandleTable.cpp
+ *
+ * Implements the generational handle table.
+ */
+
+#include "HandleTable.h"
+
+const uint32_t ObjectHandle::kNullSlot;
+
+ObjectHandle HandleTable::acquire(uint32_t position)
+{
+  ObjectHandle handle;
+  if (mFreeSlots.empty())
+  {
+    handle.slot = (uint32_t)mSlots.size();
+    mSlots.push_back(Slot());
+  }
+  else
+  {
+    handle.slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+  }
+  Slot &slot = mSlots[handle.slot];
+  slot.position = position;
+  handle.generation = slot.generation;
+  return handle;
+}
+
+void HandleTable::release(uint32_t slot)
+{
+  mSlots[slot].generation++;
+  mFreeSlots.push_back(slot);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file HandleTable.h
+ *
+ * Defines generational handles, and the table that maps them to where
+ * their objects are now.  A handle is a slot in the table and the slot's
+ * generation when the handle was given out.  Freeing a slot moves its
+ * generation on, so every handle to it goes stale at once, and a later
+ * object in the same slot can't be mistaken for the old one.
+ *
+ * Checking or following a handle is an index and a compare, with no
+ * search and no reference counting.
+ */
+
+#ifndef HANDLE_TABLE_H_2026_10_17
+#define HANDLE_TABLE_H_2026_10_17
+
+#include <vector>
+#include <stdint.h>
+
+struct ObjectHandle
+{
+  static const uint32_t kNullSlot = 0xFFFFFFFF;
+
+  uint32_t slot = kNullSlot;
+  uint32_t generation = 0;
+
+  bool isNull() const { return slot == kNullSlot; }
+
+  bool operator==(const ObjectHandle &other) const
+  {
+    return slot == other.slot && generation == other.generation;
+  }
+  bool operator!=(const ObjectHandle &other) const { return !(*this == other); }
+};
+
+class HandleTable
+{
+public:
+  HandleTable() {}
+
+  // Takes a slot for an object at the given position, reusing a freed
+  // one when there is one.
+  ObjectHandle acquire(uint32_t position);
+
+  // Frees the slot, making every handle to it stale.
+  void release(uint32_t slot);
+
+  bool isValid(ObjectHandle handle) const
+  {
+    return handle.slot < mSlots.size() && mSlots[handle.slot].generation == handle.generation;
+  }
+
+  uint32_t getPosition(uint32_t slot) const { return mSlots[slot].position; }
+  void setPosition(uint32_t slot, uint32_t position) { mSlots[slot].position = position; }
+
+private:
+  struct Slot
+  {
+    uint32_t generation = 0;
+    uint32_t position = 0;
+  };
+
+  std::vector<Slot> mSlots;
+  std::vector<uint32_t> mFreeSlots;
+};
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file HeadlessMain.cpp
+ *
+ * Runs the single player asteroid field with no window, for servers and
+ * quick checks of the simulation on machines without a display.  A ship
+ * that spins and fires without stopping stands in for the player.
+ *
+ * Usage: AsteroidsHeadless [ticks] [width] [height] [threads]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory>
+
+#include "AsteroidField.h"
+#include "Ship.h"
+
+static const int kDefaultTicks = 6000;
+static const unsigned int kDefaultWidth = 1920;
+static const unsigned int kDefaultHeight = 1080;
+static const int kTicksPerSecond = 100;
+static const int kReportTicks = 1000;
+static const int kPlayerTeamIndex = 0;
+static const uint64_t kSeed = 1;
+
+int main(int argc, char *argv[])
+{
+  int ticks = argc > 1 ? atoi(argv[1]) : kDefaultTicks;
+  sf::Vector2u spaceSize(
+    argc > 2 ? (unsigned int)atoi(argv[2]) : kDefaultWidth,
+    argc > 3 ? (unsigned int)atoi(argv[3]) : kDefaultHeight);
+  int threads = argc > 4 ? atoi(argv[4]) : 1;
+  sf::Time tickTime = sf::seconds(1.0F / kTicksPerSecond);
+
+  AsteroidField field;
+  field.getRandom().seed(kSeed);
+  field.setUpdateThreads(threads);
+
+  Ship::Config shipConfig;
+  shipConfig.baseColor = sf::Color::Green;
+  shipConfig.sizeRadius = (float)(spaceSize.x / 40);
+  shipConfig.headToHead = false;
+  Ship::Controls controls;
+  controls.rotateLeft = true;
+  controls.fire = true;
+  ObjectHandle shipHandle;
+
+  int levels = 0;
+  for (int tick = 0; tick < ticks; tick++)
+  {
+    if (field.getAsteroidTeamCount() == 0)
+    {
+      AsteroidField::FieldConfig fieldConfig;
+      fieldConfig.maxAsteroids = 30;
+      fieldConfig.minAsteroids = 20;
+      fieldConfig.maxLinearSpeed = 750;
+      fieldConfig.maxRadialSpeed = 2 * PI * 5;
+      fieldConfig.minAsteroidSize = 25;
+      fieldConfig.maxAsteroidSize = 0.05F * spaceSize.x;
+      field.populateField(fieldConfig, spaceSize);
+      levels++;
+    }
+
+    if (!field.isPresent(shipHandle))
+    {
+      // A new ship in the middle each time
+      auto ship = std::make_shared<Ship>(shipConfig);
+      ship->setPosition(sf::Vector2f((float)(spaceSize.x / 2), (float)(spaceSize.y / 2)));
+      ship->setTeam(kPlayerTeamIndex);
+      ship->updateControls(controls);
+      field.disintegrateAround(ship->getPosition(), 0.2F * spaceSize.x, spaceSize);
+      shipHandle = field.add(ship);
+    }
+
+    field.step(tickTime, spaceSize);
+
+    if ((tick + 1) % kReportTicks == 0)
+    {
+      printf("tick %d: level %d, %d asteroids left\n", tick + 1, levels, field.getAsteroidTeamCount());
+    }
+  }
+
+  return 0;
+}
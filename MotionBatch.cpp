@@ -0,0 +1,223 @@
+/**
+ * @file MotionBatch.cpp
+ *
+ * Implements the pass that moves the passive objects together.
+ */
+
+#include "MotionBatch.h"
+#include "GraphObj.h"
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#define MOTION_BATCH_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOTION_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+static const float kTwoPi = 2 * PI;
+
+#if defined(MOTION_BATCH_AVX2)
+
+static const uint32_t kLanes = 8;
+
+// Moves whole groups of lanes, step for step as GraphObj::update does,
+// and returns the first row left over.  Each new value is blended with
+// the old by the passive mask, so the other rows come through as they
+// were.
+static uint32_t integrateLanes(EntityStore *entities, uint32_t first, uint32_t last, float deltaSeconds,
+                               sf::Vector2f limits, uint8_t *outOfBounds)
+{
+  __m256 deltaT = _mm256_set1_ps(deltaSeconds);
+  __m256 zero = _mm256_setzero_ps();
+  __m256 twoPi = _mm256_set1_ps(kTwoPi);
+  __m256 negTwoPi = _mm256_set1_ps(-kTwoPi);
+  __m256 limitX = _mm256_set1_ps(limits.x);
+  __m256 limitY = _mm256_set1_ps(limits.y);
+
+  uint32_t row = first;
+  for (; row + kLanes <= last; row += kLanes)
+  {
+    __m128i passiveBytes = _mm_loadl_epi64((const __m128i *)(entities->passive.data() + row));
+    __m256 passive = _mm256_castsi256_ps(
+      _mm256_cmpgt_epi32(_mm256_cvtepu8_epi32(passiveBytes), _mm256_setzero_si256()));
+    int passiveBits = _mm256_movemask_ps(passive);
+    if (passiveBits == 0)
+    {
+      memset(outOfBounds + (row - first), 0, kLanes);
+      continue;
+    }
+
+    float *lifeAt = entities->life.data() + row;
+    __m256 life = _mm256_loadu_ps(lifeAt);
+    __m256 living = _mm256_cmp_ps(life, zero, _CMP_GT_OQ);
+    __m256 newLife = _mm256_sub_ps(life, _mm256_and_ps(living, deltaT));
+    __m256 expired = _mm256_and_ps(_mm256_cmp_ps(newLife, zero, _CMP_LE_OQ), passive);
+    newLife = _mm256_andnot_ps(expired, newLife);
+    _mm256_storeu_ps(lifeAt, _mm256_blendv_ps(life, newLife, passive));
+
+    float *xAt = entities->positionX.data() + row;
+    float *yAt = entities->positionY.data() + row;
+    __m256 moveX = _mm256_mul_ps(_mm256_loadu_ps(entities->velocityX.data() + row), deltaT);
+    __m256 moveY = _mm256_mul_ps(_mm256_loadu_ps(entities->velocityY.data() + row), deltaT);
+    __m256 oldX = _mm256_loadu_ps(xAt);
+    __m256 oldY = _mm256_loadu_ps(yAt);
+    __m256 x = _mm256_add_ps(oldX, moveX);
+    __m256 y = _mm256_add_ps(oldY, moveY);
+    float *lastMoveXAt = entities->lastMoveX.data() + row;
+    float *lastMoveYAt = entities->lastMoveY.data() + row;
+    _mm256_storeu_ps(lastMoveXAt, _mm256_blendv_ps(_mm256_loadu_ps(lastMoveXAt), moveX, passive));
+    _mm256_storeu_ps(lastMoveYAt, _mm256_blendv_ps(_mm256_loadu_ps(lastMoveYAt), moveY, passive));
+    _mm256_storeu_ps(xAt, _mm256_blendv_ps(oldX, x, passive));
+    _mm256_storeu_ps(yAt, _mm256_blendv_ps(oldY, y, passive));
+
+    float *angleAt = entities->angle.data() + row;
+    float *lastTurnAt = entities->lastTurn.data() + row;
+    __m256 turn = _mm256_mul_ps(_mm256_loadu_ps(entities->radialVelocity.data() + row), deltaT);
+    __m256 oldAngle = _mm256_loadu_ps(angleAt);
+    __m256 angle = _mm256_add_ps(oldAngle, turn);
+    angle = _mm256_sub_ps(angle, _mm256_and_ps(_mm256_cmp_ps(angle, twoPi, _CMP_GT_OQ), twoPi));
+    angle = _mm256_add_ps(angle, _mm256_and_ps(_mm256_cmp_ps(angle, negTwoPi, _CMP_LT_OQ), twoPi));
+    _mm256_storeu_ps(lastTurnAt, _mm256_blendv_ps(_mm256_loadu_ps(lastTurnAt), turn, passive));
+    _mm256_storeu_ps(angleAt, _mm256_blendv_ps(oldAngle, angle, passive));
+
+    __m256 outside = _mm256_or_ps(
+      _mm256_or_ps(_mm256_cmp_ps(x, zero, _CMP_LT_OQ), _mm256_cmp_ps(x, limitX, _CMP_GT_OQ)),
+      _mm256_or_ps(_mm256_cmp_ps(y, zero, _CMP_LT_OQ), _mm256_cmp_ps(y, limitY, _CMP_GT_OQ)));
+    int outsideBits = _mm256_movemask_ps(_mm256_and_ps(outside, passive));
+    int expiredBits = _mm256_movemask_ps(expired);
+    for (uint32_t lane = 0; lane < kLanes; lane++)
+    {
+      outOfBounds[row - first + lane] = (uint8_t)((outsideBits >> lane) & 1);
+      if ((expiredBits >> lane) & 1)
+      {
+        entities->alive[row + lane] = 0;
+      }
+    }
+  }
+  return row;
+}
+
+#elif defined(MOTION_BATCH_SSE2)
+
+static const uint32_t kLanes = 4;
+
+static inline __m128 blend(__m128 oldValue, __m128 newValue, __m128 mask)
+{
+  return _mm_or_ps(_mm_and_ps(mask, newValue), _mm_andnot_ps(mask, oldValue));
+}
+
+// Moves whole groups of lanes, step for step as GraphObj::update does,
+// and returns the first row left over.  Each new value is blended with
+// the old by the passive mask, so the other rows come through as they
+// were.
+static uint32_t integrateLanes(EntityStore *entities, uint32_t first, uint32_t last, float deltaSeconds,
+                               sf::Vector2f limits, uint8_t *outOfBounds)
+{
+  __m128 deltaT = _mm_set1_ps(deltaSeconds);
+  __m128 zero = _mm_setzero_ps();
+  __m128 twoPi = _mm_set1_ps(kTwoPi);
+  __m128 negTwoPi = _mm_set1_ps(-kTwoPi);
+  __m128 limitX = _mm_set1_ps(limits.x);
+  __m128 limitY = _mm_set1_ps(limits.y);
+
+  uint32_t row = first;
+  for (; row + kLanes <= last; row += kLanes)
+  {
+    int32_t passiveWord;
+    memcpy(&passiveWord, entities->passive.data() + row, sizeof(passiveWord));
+    __m128i passiveBytes = _mm_cvtsi32_si128(passiveWord);
+    __m128i passiveInts = _mm_unpacklo_epi16(_mm_unpacklo_epi8(passiveBytes, _mm_setzero_si128()), _mm_setzero_si128());
+    __m128 passive = _mm_castsi128_ps(_mm_cmpgt_epi32(passiveInts, _mm_setzero_si128()));
+    int passiveBits = _mm_movemask_ps(passive);
+    if (passiveBits == 0)
+    {
+      memset(outOfBounds + (row - first), 0, kLanes);
+      continue;
+    }
+
+    float *lifeAt = entities->life.data() + row;
+    __m128 life = _mm_loadu_ps(lifeAt);
+    __m128 living = _mm_cmpgt_ps(life, zero);
+    __m128 newLife = _mm_sub_ps(life, _mm_and_ps(living, deltaT));
+    __m128 expired = _mm_and_ps(_mm_cmple_ps(newLife, zero), passive);
+    newLife = _mm_andnot_ps(expired, newLife);
+    _mm_storeu_ps(lifeAt, blend(life, newLife, passive));
+
+    float *xAt = entities->positionX.data() + row;
+    float *yAt = entities->positionY.data() + row;
+    __m128 moveX = _mm_mul_ps(_mm_loadu_ps(entities->velocityX.data() + row), deltaT);
+    __m128 moveY = _mm_mul_ps(_mm_loadu_ps(entities->velocityY.data() + row), deltaT);
+    __m128 oldX = _mm_loadu_ps(xAt);
+    __m128 oldY = _mm_loadu_ps(yAt);
+    __m128 x = _mm_add_ps(oldX, moveX);
+    __m128 y = _mm_add_ps(oldY, moveY);
+    float *lastMoveXAt = entities->lastMoveX.data() + row;
+    float *lastMoveYAt = entities->lastMoveY.data() + row;
+    _mm_storeu_ps(lastMoveXAt, blend(_mm_loadu_ps(lastMoveXAt), moveX, passive));
+    _mm_storeu_ps(lastMoveYAt, blend(_mm_loadu_ps(lastMoveYAt), moveY, passive));
+    _mm_storeu_ps(xAt, blend(oldX, x, passive));
+    _mm_storeu_ps(yAt, blend(oldY, y, passive));
+
+    float *angleAt = entities->angle.data() + row;
+    float *lastTurnAt = entities->lastTurn.data() + row;
+    __m128 turn = _mm_mul_ps(_mm_loadu_ps(entities->radialVelocity.data() + row), deltaT);
+    __m128 oldAngle = _mm_loadu_ps(angleAt);
+    __m128 angle = _mm_add_ps(oldAngle, turn);
+    angle = _mm_sub_ps(angle, _mm_and_ps(_mm_cmpgt_ps(angle, twoPi), twoPi));
+    angle = _mm_add_ps(angle, _mm_and_ps(_mm_cmplt_ps(angle, negTwoPi), twoPi));
+    _mm_storeu_ps(lastTurnAt, blend(_mm_loadu_ps(lastTurnAt), turn, passive));
+    _mm_storeu_ps(angleAt, blend(oldAngle, angle, passive));
+
+    __m128 outside = _mm_or_ps(
+      _mm_or_ps(_mm_cmplt_ps(x, zero), _mm_cmpgt_ps(x, limitX)),
+      _mm_or_ps(_mm_cmplt_ps(y, zero), _mm_cmpgt_ps(y, limitY)));
+    int outsideBits = _mm_movemask_ps(_mm_and_ps(outside, passive));
+    int expiredBits = _mm_movemask_ps(expired);
+    for (uint32_t lane = 0; lane < kLanes; lane++)
+    {
+      outOfBounds[row - first + lane] = (uint8_t)((outsideBits >> lane) & 1);
+      if ((expiredBits >> lane) & 1)
+      {
+        entities->alive[row + lane] = 0;
+      }
+    }
+  }
+  return row;
+}
+
+#else
+
+static uint32_t integrateLanes(EntityStore *, uint32_t first, uint32_t, float, sf::Vector2f, uint8_t *)
+{
+  return first;
+}
+
+#endif
+
+void MotionBatch::integrate(EntityStore *entities, uint32_t first, uint32_t last, float deltaSeconds,
+                            sf::Vector2f limits)
+{
+  mFirst = first;
+  mOutOfBounds.resize(last - first);
+  uint8_t *outOfBounds = mOutOfBounds.data();
+
+  // The rows left over after the last whole group move one at a time.
+  for (uint32_t row = integrateLanes(entities, first, last, deltaSeconds, limits, outOfBounds); row < last; row++)
+  {
+    outOfBounds[row - first] = entities->passive[row] && entities->advance(row, deltaSeconds, limits) ? 1 : 0;
+  }
+}
+
+const char *MotionBatch::getInstructionSet()
+{
+#if defined(MOTION_BATCH_AVX2)
+  return "AVX2";
+#elif defined(MOTION_BATCH_SSE2)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
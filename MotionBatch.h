@@ -0,0 +1,42 @@
+/**
+ * @file MotionBatch.h
+ *
+ * Defines the pass that moves the passive objects in a run of a game
+ * box's store rows together.  Their state is already an array per
+ * property, so it is advanced where it lies, with AVX2 or SSE2 where the
+ * compiler targets them (plain code otherwise); the other rows are
+ * masked out and left for their objects to update.  That saves a call
+ * and its branches for every drifting rock, bolt and fragment.
+ *
+ * The result is exactly what GraphObj::update gives each object.
+ */
+
+#ifndef MOTION_BATCH_H_2026_10_17
+#define MOTION_BATCH_H_2026_10_17
+
+#include <vector>
+#include <stdint.h>
+#include "EntityStore.h"
+
+class MotionBatch
+{
+public:
+  MotionBatch() {}
+
+  // Moves, turns and ages the passive rows from first up to last by
+  // deltaSeconds, leaving the other rows alone.
+  void integrate(EntityStore *entities, uint32_t first, uint32_t last, float deltaSeconds, sf::Vector2f limits);
+
+  // Whether a passive row left the space limits in the last integrate(),
+  // and needs its object to wrap it.
+  bool isOutOfBounds(uint32_t row) const { return mOutOfBounds[row - mFirst] != 0; }
+
+  // The instruction set the integration was built for.
+  static const char *getInstructionSet();
+
+private:
+  uint32_t mFirst = 0;
+  std::vector<uint8_t> mOutOfBounds; // For each row from mFirst
+};
+
+#endif
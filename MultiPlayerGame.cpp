@@ -7,6 +7,7 @@
 #include "GameBox.h"
 #include "Ship.h"
 #include "Asteroid.h"
+#include "ShipRespawn.h"
 
 static const int kMaxFps = 100;
 static const float kShipRadius = 40.0F;
@@ -32,21 +33,31 @@ public:
     sf::Keyboard::Key fireKey;
     float respawnSeconds = 0;
   };
-  HeadToHeadPlayer(const Config &config) : mConfig(config) {}
+  HeadToHeadPlayer(const Config &config) : mConfig(config), mRespawn(sf::seconds(config.respawnSeconds)) {}
   void update(GameBox *box, sf::RenderWindow &win);
-  void setShip(std::shared_ptr<Ship> ship) { mShip = ship; }
+
+  // The ship in play, and how to build its replacements.
+  void setShip(ObjectHandle ship, const Ship::Config &shipConfig, int teamIndex)
+  {
+    mShip = ship;
+    mShipConfig = shipConfig;
+    mTeamIndex = teamIndex;
+  }
   sf::Color getTeamColor() { return mConfig.teamColor; }
 private:
   Config mConfig;
-  bool mRespawning = false;
-  sf::Clock mRespawnClock;
-  std::shared_ptr<Ship> mShip;
+  ShipRespawn mRespawn;
+  sf::Clock mClock;
+  Ship::Config mShipConfig;
+  int mTeamIndex = 0;
+  ObjectHandle mShip;
 };
 
 void HeadToHeadPlayer::update(GameBox *box, sf::RenderWindow &win)
 {
-  if (box && mShip)
+  if (box)
   {
+    Ship *ship = static_cast<Ship *>(box->getObject(mShip));
     Ship::Controls controls;
     if (sf::Keyboard::isKeyPressed(mConfig.leftKey))
     {
@@ -64,32 +75,23 @@ void HeadToHeadPlayer::update(GameBox *box, sf::RenderWindow &win)
     {
       controls.fire = true;
     }
-    mShip->updateControls(controls);
-
-    if (mRespawning && !box->isPresent(mShip))
+    if (ship)
     {
-      if (mRespawnClock.getElapsedTime().asSeconds() > mConfig.respawnSeconds)
-      {
-        mShip->revive();
-        mShip->setPosition(
-          sf::Vector2f(
-            randFloat(0, (float)win.getSize().x), 
-            randFloat(0, (float)win.getSize().y)
-          )
-        );
-        mShip->setLinearVelocity(sf::Vector2f(0, 0));
-        mShip->setOrientation(randFloat(0, 2 * PI));
-        mShip->setRadialVelocity(0);
-        box->add(mShip);
-      }
+      ship->updateControls(controls);
     }
-    else
+
+    if (mRespawn.update(*box, mShip, mClock.getElapsedTime()))
     {
-      if (!mShip->isAlive())
-      {
-        mRespawning = true;
-        mRespawnClock.restart();
-      }
+      auto newShip = std::make_shared<Ship>(mShipConfig);
+      newShip->setTeam(mTeamIndex);
+      newShip->setPosition(
+        sf::Vector2f(
+          box->getRandom().randFloat(0, (float)win.getSize().x), 
+          box->getRandom().randFloat(0, (float)win.getSize().y)
+        )
+      );
+      newShip->setOrientation(box->getRandom().randFloat(0, 2 * PI));
+      mShip = box->add(newShip);
     }
   }
 }
@@ -126,16 +128,16 @@ static void singlePlayerGame()
   sf::Vector2f pos((float)(window.getSize().x * (teamIndex + 1) / (numPlayers + 1)), (float)(window.getSize().y / 2));
   ship->setPosition(pos);
   ship->setOrientation((float)(-PI / 2));
-  ship->setTeam(teamIndex++);
-  player.setShip(ship);
-  gameBox.add(ship);
+  ship->setTeam(teamIndex);
+  player.setShip(gameBox.add(ship), shipConfig, teamIndex);
+  teamIndex++;
 
   // Testing only:
   Asteroid::Config asteroidConfig = {};
   asteroidConfig.maxSize = kMaxAsteroidRadius;
   asteroidConfig.minSize = kMinAsteroidRadius;
   asteroidConfig.color = kAsteroidColor;
-  auto testAsteroid = std::make_shared<Asteroid>(asteroidConfig);
+  auto testAsteroid = std::make_shared<Asteroid>(asteroidConfig, gameBox.getRandom());
   gameBox.add(testAsteroid);
   sf::Vector2f asteroidPos((float)(window.getSize().x * (teamIndex + 1) / 2), (float)(window.getSize().y / 4));
   testAsteroid->setPosition(asteroidPos);
@@ -184,7 +186,7 @@ public:
 
 void AsteroidField::populateField(FieldConfig config, const sf::RenderWindow& window)
 {
-  int numAsteroids = randInt(config.minAsteroids, config.maxAsteroids);
+  int numAsteroids = getRandom().randInt(config.minAsteroids, config.maxAsteroids);
 
   for (int index = 0; index < numAsteroids; index++)
   {
@@ -192,15 +194,15 @@ void AsteroidField::populateField(FieldConfig config, const sf::RenderWindow& wi
     asteroidConfig.maxSize = config.maxAsteroidSize;
     asteroidConfig.minSize = config.minAsteroidSize;
     asteroidConfig.minChildSize = config.minAsteroidSize;
-    float colorRatio = randFloat(0, 1);
+    float colorRatio = getRandom().randFloat(0, 1);
     asteroidConfig.color = sf::Color(
       (int)(config.minColor.r + (config.maxColor.r - config.minColor.r) * colorRatio),
       (int)(config.minColor.g + (config.maxColor.g - config.minColor.g) * colorRatio),
       (int)(config.minColor.b + (config.maxColor.b - config.minColor.b) * colorRatio));
-    auto asteroid = std::make_shared<Asteroid>(asteroidConfig);
-    sf::Vector2f asteroidPos(randFloat(0, window.getSize().x), randFloat(0, window.getSize().y));
+    auto asteroid = std::make_shared<Asteroid>(asteroidConfig, getRandom());
+    sf::Vector2f asteroidPos(getRandom().randFloat(0, window.getSize().x), getRandom().randFloat(0, window.getSize().y));
     asteroid->setPosition(asteroidPos);
-    asteroid->knockAsteriod(0, config.maxLinearSpeed);
+    asteroid->knockAsteriod(0, config.maxLinearSpeed, getRandom());
     add(asteroid);
   }
 }
@@ -211,8 +213,12 @@ void AsteroidField::disintegrateAround(sf::Vector2f center, float radius, const
   sf::Vector2u winSize = window.getSize();
   float doubleWinSizeX = winSize.x * winSize.x;
   float doubleWinSizeY = winSize.y * winSize.y;
-  for (auto obj : mObjects)
+  for (auto &obj : mObjects)
   {
+    if (!obj)
+    {
+      continue;
+    }
     sf::Vector2f pt = obj->getPosition();
     sf::Vector2f delta = pt - center;
     sf::Vector2f doubleDelta(delta.x * delta.x, delta.y * delta.y);
@@ -276,9 +282,9 @@ static void headToHeadGame()
     sf::Vector2f pos((float)(window.getSize().x * (teamIndex + 1) / (kNumPlayers + 1)), (float)(window.getSize().y / 2));
     ship->setPosition(pos);
     ship->setOrientation((float)(-PI / 2));
-    ship->setTeam(teamIndex++);
-    player.setShip(ship);
-    gameBox.add(ship);
+    ship->setTeam(teamIndex);
+    player.setShip(gameBox.add(ship), config, teamIndex);
+    teamIndex++;
   }
 
   // Testing only:
@@ -286,7 +292,7 @@ static void headToHeadGame()
   asteroidConfig.maxSize = kMaxAsteroidRadius;
   asteroidConfig.minSize = kMinAsteroidRadius;
   asteroidConfig.color = kAsteroidColor;
-  auto testAsteroid = std::make_shared<Asteroid>(asteroidConfig);
+  auto testAsteroid = std::make_shared<Asteroid>(asteroidConfig, gameBox.getRandom());
   gameBox.add(testAsteroid);
   sf::Vector2f asteroidPos((float)(window.getSize().x * (teamIndex + 1) / 2), (float)(window.getSize().y / 4));
   testAsteroid->setPosition(asteroidPos);
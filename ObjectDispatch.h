@@ -0,0 +1,46 @@
+/**
+ * @file ObjectDispatch.h
+ *
+ * Calls into game objects without going through the vtable.  The kinds
+ * of object in play are a closed set, each one a final class tagged with
+ * its ObjectType, so a switch on the tag can hand a function the object
+ * as its own type.  Every call the function makes on it is then direct,
+ * and the compiler can inline the ones it can see.  Objects of any other
+ * type are handed over as a GraphObj, and dispatched as usual.
+ */
+
+#ifndef OBJECT_DISPATCH_H_2026_10_17
+#define OBJECT_DISPATCH_H_2026_10_17
+
+#include <type_traits>
+#include "Asteroid.h"
+#include "Bolt.h"
+#include "Fragment.h"
+#include "Ship.h"
+
+// The type, made const when Object is.
+template <typename Object, typename Type>
+using MatchConst = typename std::conditional<std::is_const<Object>::value, const Type, Type>::type;
+
+// Calls function with the object, a GraphObj or a const one, as its final
+// type.  The function must take every type, as a generic lambda does,
+// and return the same type for each.
+template <typename Object, typename Function>
+inline auto visitObject(Object &obj, Function &&function) -> decltype(function(obj))
+{
+  switch (obj.getType())
+  {
+  case ObjectType::Ship:
+    return function(static_cast<MatchConst<Object, Ship> &>(obj));
+  case ObjectType::Asteroid:
+    return function(static_cast<MatchConst<Object, Asteroid> &>(obj));
+  case ObjectType::Bolt:
+    return function(static_cast<MatchConst<Object, Bolt> &>(obj));
+  case ObjectType::Fragment:
+    return function(static_cast<MatchConst<Object, Fragment> &>(obj));
+  default:
+    return function(obj);
+  }
+}
+
+#endif
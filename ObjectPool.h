@@ -0,0 +1,241 @@
+/**
+ * @file ObjectPool.h
+ *
+ * Defines free-list pools for the objects that are spawned in large
+ * numbers every frame (bolts, fragments and asteroid pieces).
+ *
+ * Objects are created with makePooled, which places the object and its
+ * shared_ptr control block in one block taken from a per-type free list.
+ * When the last reference goes away (normally when GameBox::update drops a
+ * dead object) the block goes back on the free list instead of the heap,
+ * so once a game has warmed up, spawning stops allocating.
+ */
+
+#ifndef OBJECT_POOL_H_2026_10_17
+#define OBJECT_POOL_H_2026_10_17
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <stdint.h>
+
+struct PoolStats
+{
+  uint64_t heapAllocations = 0;   // Blocks that had to come from the heap
+  uint64_t pooledAllocations = 0; // Blocks reused from a free list
+  uint64_t releases = 0;          // Blocks returned to a free list
+};
+
+namespace ObjectPoolDetail
+{
+  struct Counters
+  {
+    std::atomic<uint64_t> heapAllocations{ 0 };
+    std::atomic<uint64_t> pooledAllocations{ 0 };
+    std::atomic<uint64_t> releases{ 0 };
+  };
+
+  inline Counters &counters()
+  {
+    static Counters sCounters;
+    return sCounters;
+  }
+
+  struct FreeNode
+  {
+    FreeNode *next;
+  };
+
+  // Blocks move between a thread's own list and the shared depot this
+  // many at a time, so the depot's lock is taken once per batch.
+  static const size_t kBatchSize = 64;
+
+  // The free blocks of one size that no thread is holding.  Objects are
+  // often freed on a different thread from the one that made them - a
+  // bolt spawned by an update worker dies on the main thread - so the
+  // freeing thread's list grows while the making thread's runs dry.  The
+  // depot evens them out: a list spills into it when it grows long, and
+  // refills from it before going to the heap.
+  template <size_t BlockSize>
+  class Depot
+  {
+  public:
+    // Hands over a whole chain of count blocks.
+    void give(FreeNode *head, FreeNode *tail, size_t count)
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      tail->next = mHead;
+      mHead = head;
+      mCount += count;
+    }
+
+    // Takes up to a batch of blocks, returning the chain and its length.
+    FreeNode *take(size_t *count)
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      FreeNode *head = mHead;
+      FreeNode *tail = nullptr;
+      size_t taken = 0;
+      for (FreeNode *node = mHead; node != nullptr && taken < kBatchSize; node = node->next)
+      {
+        tail = node;
+        taken++;
+      }
+      if (tail != nullptr)
+      {
+        mHead = tail->next;
+        tail->next = nullptr;
+      }
+      mCount -= taken;
+      *count = taken;
+      return taken > 0 ? head : nullptr;
+    }
+
+    // Never destroyed, so that threads can still hand their blocks back
+    // as they exit, whenever that is.
+    static Depot &shared()
+    {
+      static Depot *sDepot = new Depot();
+      return *sDepot;
+    }
+
+  private:
+    std::mutex mMutex;
+    FreeNode *mHead = nullptr;
+    size_t mCount = 0;
+  };
+
+  // A list of free blocks, all of one size.  Each thread keeps its own
+  // list, so allocating and freeing only take a lock when a batch moves
+  // to or from the depot.
+  template <size_t BlockSize>
+  class FreeList
+  {
+  public:
+    ~FreeList()
+    {
+      if (mHead != nullptr)
+      {
+        FreeNode *tail = mHead;
+        while (tail->next != nullptr)
+        {
+          tail = tail->next;
+        }
+        Depot<BlockSize>::shared().give(mHead, tail, mCount);
+      }
+    }
+
+    void *pop()
+    {
+      if (mHead == nullptr)
+      {
+        mHead = Depot<BlockSize>::shared().take(&mCount);
+      }
+      if (mHead == nullptr)
+      {
+        counters().heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(BlockSize < sizeof(void *) ? sizeof(void *) : BlockSize);
+      }
+      FreeNode *node = mHead;
+      mHead = node->next;
+      mCount--;
+      counters().pooledAllocations.fetch_add(1, std::memory_order_relaxed);
+      return node;
+    }
+
+    void push(void *block)
+    {
+      FreeNode *node = static_cast<FreeNode *>(block);
+      node->next = mHead;
+      mHead = node;
+      mCount++;
+      counters().releases.fetch_add(1, std::memory_order_relaxed);
+
+      // Keep a batch to hand, and spill the one before it
+      if (mCount >= 2 * kBatchSize)
+      {
+        FreeNode *tail = mHead;
+        for (size_t index = 1; index < kBatchSize; index++)
+        {
+          tail = tail->next;
+        }
+        FreeNode *spilled = tail->next;
+        tail->next = nullptr;
+        FreeNode *spilledTail = spilled;
+        while (spilledTail->next != nullptr)
+        {
+          spilledTail = spilledTail->next;
+        }
+        Depot<BlockSize>::shared().give(spilled, spilledTail, mCount - kBatchSize);
+        mCount = kBatchSize;
+      }
+    }
+
+    static FreeList &local()
+    {
+      static thread_local FreeList sFreeList;
+      return sFreeList;
+    }
+
+  private:
+    FreeNode *mHead = nullptr;
+    size_t mCount = 0;
+  };
+}
+
+// Standard allocator over the free lists.  Single objects come from the
+// pool, anything else goes straight to the heap.
+template <typename T>
+class PoolAllocator
+{
+public:
+  typedef T value_type;
+
+  PoolAllocator() {}
+  template <typename U> PoolAllocator(const PoolAllocator<U> &) {}
+
+  T *allocate(size_t count)
+  {
+    if (count == 1)
+    {
+      return static_cast<T *>(ObjectPoolDetail::FreeList<sizeof(T)>::local().pop());
+    }
+    return static_cast<T *>(::operator new(count * sizeof(T)));
+  }
+
+  void deallocate(T *ptr, size_t count)
+  {
+    if (count == 1)
+    {
+      ObjectPoolDetail::FreeList<sizeof(T)>::local().push(ptr);
+    }
+    else
+    {
+      ::operator delete(ptr);
+    }
+  }
+
+  template <typename U> bool operator==(const PoolAllocator<U> &) const { return true; }
+  template <typename U> bool operator!=(const PoolAllocator<U> &) const { return false; }
+};
+
+template <typename T, typename... Args>
+std::shared_ptr<T> makePooled(Args &&... args)
+{
+  return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+// A snapshot of the allocation counts of all pools since startup.
+inline PoolStats getPoolStats()
+{
+  auto &counters = ObjectPoolDetail::counters();
+  PoolStats stats;
+  stats.heapAllocations = counters.heapAllocations.load(std::memory_order_relaxed);
+  stats.pooledAllocations = counters.pooledAllocations.load(std::memory_order_relaxed);
+  stats.releases = counters.releases.load(std::memory_order_relaxed);
+  return stats;
+}
+
+#endif
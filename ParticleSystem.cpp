@@ -0,0 +1,217 @@
+/**
+ * @file ParticleSystem.cpp
+ *
+ * Implements the particle system for explosion fragments.
+ */
+
+#include "ParticleSystem.h"
+#include "RenderBatch.h"
+
+#include <algorithm>
+
+// The same shapes as Fragment
+static const float kMinSideRatio = 0.25F;
+static const float kMaxSideRatio = 0.75F;
+
+// The share of each new frame time in the smoothed one
+static const float kFrameTimeSmoothing = 0.1F;
+
+ParticleSystem::ParticleSystem(size_t capacity)
+{
+  setCapacity(capacity);
+}
+
+void ParticleSystem::setCapacity(size_t capacity)
+{
+  mParticles.assign(capacity > 0 ? capacity : 1, Particle());
+  clear();
+}
+
+void ParticleSystem::clear()
+{
+  for (auto &particle : mParticles)
+  {
+    particle.remainingLifeSeconds = 0;
+  }
+  mFirst = 0;
+  mCount = 0;
+  mLiveCount = 0;
+}
+
+void ParticleSystem::setFrameTime(sf::Time frameTime)
+{
+  mFrameSeconds += (frameTime.asSeconds() - mFrameSeconds) * kFrameTimeSmoothing;
+}
+
+// Where value sits from start (1) to end (0), clamped
+static float falloff(float value, float start, float end)
+{
+  if (value <= start)
+  {
+    return 1;
+  }
+  if (value >= end)
+  {
+    return 0;
+  }
+  return (end - value) / (end - start);
+}
+
+float ParticleSystem::getDetail() const
+{
+  float detail = 1;
+  if (mBudget.hardParticleLimit > mBudget.softParticleLimit)
+  {
+    detail = falloff((float)mLiveCount, (float)mBudget.softParticleLimit, (float)mBudget.hardParticleLimit);
+  }
+  else if (mLiveCount >= mBudget.hardParticleLimit)
+  {
+    detail = 0;
+  }
+
+  float target = mBudget.frameTimeTarget.asSeconds();
+  float ceiling = mBudget.frameTimeCeiling.asSeconds();
+  if (target > 0 && ceiling > target)
+  {
+    float frameDetail = mBudget.minFrameDetail + (1 - mBudget.minFrameDetail) * falloff(mFrameSeconds, target, ceiling);
+    detail = std::min(detail, frameDetail);
+  }
+  return detail;
+}
+
+float ParticleSystem::getLifespanScale(float detail) const
+{
+  return std::max(detail, mBudget.minLifespanScale);
+}
+
+ParticleSystem::Particle ParticleSystem::makeFire(float size, sf::Color color)
+{
+  Particle particle;
+  particle.isFire = true;
+  particle.color = color;
+  particle.corners[0] = sf::Vector2f(size / 2, 0);
+  particle.corners[1] = sf::Vector2f(-size / 2, -size / 4);
+  particle.corners[2] = sf::Vector2f(-size / 2, size / 4);
+  return particle;
+}
+
+ParticleSystem::Particle ParticleSystem::makeFragment(float size, sf::Color color, Random &random)
+{
+  float minSide = size * kMinSideRatio;
+  float maxSide = size * kMaxSideRatio;
+  float sides[8];
+  for (auto &side : sides)
+  {
+    side = random.randFloat(minSide, maxSide);
+  }
+
+  Particle particle;
+  particle.isFire = false;
+  particle.color = color;
+  particle.corners[0] = sf::Vector2f(sides[0], sides[1]);
+  particle.corners[1] = sf::Vector2f(sides[2], -sides[3]);
+  particle.corners[2] = sf::Vector2f(-sides[4], -sides[5]);
+  particle.corners[3] = sf::Vector2f(-sides[6], sides[7]);
+  return particle;
+}
+
+void ParticleSystem::emit(const Particle &particle)
+{
+  if (particle.remainingLifeSeconds <= 0)
+  {
+    return;
+  }
+
+  size_t capacity = mParticles.size();
+  if (mCount == capacity)
+  {
+    // Full - the oldest makes way
+    if (mParticles[mFirst].remainingLifeSeconds > 0)
+    {
+      mLiveCount--;
+    }
+    mFirst = (mFirst + 1) % capacity;
+    mCount--;
+  }
+  mParticles[(mFirst + mCount) % capacity] = particle;
+  mCount++;
+  mLiveCount++;
+}
+
+void ParticleSystem::update(sf::Time deltaT, sf::Vector2u spaceLimits)
+{
+  float deltaSeconds = deltaT.asSeconds();
+  float limitX = (float)spaceLimits.x;
+  float limitY = (float)spaceLimits.y;
+  size_t capacity = mParticles.size();
+  for (size_t offset = 0; offset < mCount; offset++)
+  {
+    Particle &particle = mParticles[(mFirst + offset) % capacity];
+    if (particle.remainingLifeSeconds <= 0)
+    {
+      continue;
+    }
+
+    particle.remainingLifeSeconds -= deltaSeconds;
+    particle.lastMove = particle.velocity * deltaSeconds;
+    particle.position += particle.lastMove;
+    particle.lastTurn = particle.radialVelocity * deltaSeconds;
+    particle.angle += particle.lastTurn;
+
+    // Fragments don't wrap - they just go
+    if (particle.remainingLifeSeconds <= 0 ||
+        particle.position.x < 0 || particle.position.x > limitX ||
+        particle.position.y < 0 || particle.position.y > limitY)
+    {
+      particle.remainingLifeSeconds = 0;
+      mLiveCount--;
+    }
+  }
+  trimDead();
+}
+
+void ParticleSystem::trimDead()
+{
+  size_t capacity = mParticles.size();
+  while (mCount > 0 && mParticles[mFirst].remainingLifeSeconds <= 0)
+  {
+    mFirst = (mFirst + 1) % capacity;
+    mCount--;
+  }
+}
+
+void ParticleSystem::render(RenderBatch &batch, float interpolation) const
+{
+  float behind = 1 - interpolation;
+  size_t capacity = mParticles.size();
+  for (size_t offset = 0; offset < mCount; offset++)
+  {
+    const Particle &particle = mParticles[(mFirst + offset) % capacity];
+    if (particle.remainingLifeSeconds <= 0)
+    {
+      continue;
+    }
+
+    sf::Vector2f center = particle.position - particle.lastMove * behind;
+    AngleFactors angleFact(particle.angle - particle.lastTurn * behind);
+    auto toWorld = [&](sf::Vector2f pt)
+    {
+      return center + sf::Vector2f(pt.x * angleFact.cosFactor - pt.y * angleFact.sinFactor,
+                                   pt.x * angleFact.sinFactor + pt.y * angleFact.cosFactor);
+    };
+
+    if (particle.isFire)
+    {
+      batch.addTriangle(sf::Vertex(toWorld(particle.corners[0]), sf::Color::White),
+                        sf::Vertex(toWorld(particle.corners[1]), particle.color),
+                        sf::Vertex(toWorld(particle.corners[2]), particle.color));
+    }
+    else
+    {
+      sf::Vertex corner0(toWorld(particle.corners[0]), particle.color);
+      sf::Vertex corner2(toWorld(particle.corners[2]), particle.color);
+      batch.addTriangle(corner0, sf::Vertex(toWorld(particle.corners[1]), particle.color), corner2);
+      batch.addTriangle(corner0, corner2, sf::Vertex(toWorld(particle.corners[3]), particle.color));
+    }
+  }
+}
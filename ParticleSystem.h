@@ -0,0 +1,119 @@
+/**
+ * @file ParticleSystem.h
+ *
+ * Defines a lightweight particle system for the fragments thrown out by
+ * explosions.  Fragments are only for show, so instead of each being a
+ * full graphic object they are plain records in a fixed-size ring buffer,
+ * updated in one loop and added to the frame's batch in another.  When
+ * the buffer is full, a new particle replaces the oldest one.
+ *
+ * Explosions ask for a level of detail before throwing particles, so
+ * that a chain reaction, or a run of slow frames, thins them out before
+ * they slow the game down further.  The particles have their own random
+ * number generator, so thinning them never changes how the game plays.
+ */
+
+#ifndef PARTICLE_SYSTEM_H_2026_10_17
+#define PARTICLE_SYSTEM_H_2026_10_17
+
+#include <vector>
+#include "GraphObj.h"
+
+class ParticleSystem
+{
+public:
+  static const size_t kDefaultCapacity = 4096;
+
+  struct Particle
+  {
+    sf::Vector2f position;
+    sf::Vector2f velocity;
+    float angle = 0;
+    float radialVelocity = 0;
+    float remainingLifeSeconds = 0;
+    sf::Vector2f lastMove; // Distance moved in the last update
+    float lastTurn = 0;    // Angle turned in the last update
+
+    // A fire particle is a spike, pointing along its angle and white at
+    // the tip.  Anything else is a quad of the body's color.
+    bool isFire = false;
+    sf::Color color;
+    sf::Vector2f corners[4]; // Relative to the position, before turning
+  };
+
+  // The limits that the level of detail scales down between.
+  struct Budget
+  {
+    // Detail falls from full at the soft limit of live particles, to
+    // nothing at the hard limit.
+    size_t softParticleLimit = 1024;
+    size_t hardParticleLimit = kDefaultCapacity;
+
+    // Detail falls from full at the target frame time, to minFrameDetail
+    // at the ceiling.  A zero target ignores the frame time.
+    sf::Time frameTimeTarget = sf::microseconds(16667);
+    sf::Time frameTimeCeiling = sf::microseconds(33333);
+    float minFrameDetail = 0.1F;
+
+    // The lifespans shrink with the detail, but no further than this.
+    float minLifespanScale = 0.25F;
+  };
+
+  explicit ParticleSystem(size_t capacity = kDefaultCapacity);
+
+  void setBudget(const Budget &budget) { mBudget = budget; }
+  const Budget &getBudget() const { return mBudget; }
+
+  // Tells the system how long the last frame took.  It's smoothed over
+  // several frames, so one slow frame doesn't empty the sky.
+  void setFrameTime(sf::Time frameTime);
+
+  // The fraction of the usual particles an explosion should throw now,
+  // from 1 (all of them) to 0 (none).
+  float getDetail() const;
+
+  // How much to scale lifespans by at the given detail.
+  float getLifespanScale(float detail) const;
+
+  Random &getRandom() { return mRandom; }
+
+  // Empties the buffer and changes its size.
+  void setCapacity(size_t capacity);
+  size_t getCapacity() const { return mParticles.size(); }
+
+  // The number of live particles.
+  size_t size() const { return mLiveCount; }
+
+  void clear();
+
+  // Builds the shape of a fire spike or a body fragment, of the given
+  // size and color.  Body fragments get random corners.
+  static Particle makeFire(float size, sf::Color color);
+  static Particle makeFragment(float size, sf::Color color, Random &random);
+
+  // Adds a particle, replacing the oldest if the buffer is full.
+  void emit(const Particle &particle);
+
+  // Moves every particle, and drops those that have run out of life or
+  // left the space limits.
+  void update(sf::Time deltaT, sf::Vector2u spaceLimits);
+
+  // Adds every particle to the frame's batch, interpolated as for
+  // GraphObj::render.
+  void render(RenderBatch &batch, float interpolation) const;
+
+private:
+  // Forgets dead particles at the old end of the buffer.
+  void trimDead();
+
+  Budget mBudget;
+  float mFrameSeconds = 0; // Smoothed frame time
+  Random mRandom;
+
+  std::vector<Particle> mParticles;
+  size_t mFirst = 0;     // Index of the oldest particle
+  size_t mCount = 0;     // Slots in use from mFirst on, dead or alive
+  size_t mLiveCount = 0;
+};
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * @file PolygonCollision.cpp
+ *
+ * Implements the exact outline collision tests.
+ */
+
+#include "PolygonCollision.h"
+
+#include <algorithm>
+#include <math.h>
+
+static float cross(sf::Vector2f a, sf::Vector2f b)
+{
+  return a.x * b.y - a.y * b.x;
+}
+
+static float dot(sf::Vector2f a, sf::Vector2f b)
+{
+  return a.x * b.x + a.y * b.y;
+}
+
+// The square of the distance from the point to the segment start-end.
+static float distanceSqToSegment(sf::Vector2f point, sf::Vector2f start, sf::Vector2f end)
+{
+  sf::Vector2f segment = end - start;
+  sf::Vector2f offset = point - start;
+  float lengthSq = dot(segment, segment);
+  if (lengthSq > 0)
+  {
+    float t = std::min(std::max(dot(offset, segment) / lengthSq, 0.0F), 1.0F);
+    offset -= segment * t;
+  }
+  return dot(offset, offset);
+}
+
+// True if segments a0-a1 and b0-b1 cross or touch.
+static bool segmentsCross(sf::Vector2f a0, sf::Vector2f a1, sf::Vector2f b0, sf::Vector2f b1)
+{
+  sf::Vector2f a = a1 - a0;
+  sf::Vector2f b = b1 - b0;
+  float sideB0 = cross(a, b0 - a0);
+  float sideB1 = cross(a, b1 - a0);
+  float sideA0 = cross(b, a0 - b0);
+  float sideA1 = cross(b, a1 - b0);
+  if (((sideB0 > 0 && sideB1 < 0) || (sideB0 < 0 && sideB1 > 0)) &&
+      ((sideA0 > 0 && sideA1 < 0) || (sideA0 < 0 && sideA1 > 0)))
+  {
+    return true;
+  }
+
+  // Touching, or in line - only a hit if an end lies on the other segment
+  return (sideB0 == 0 && distanceSqToSegment(b0, a0, a1) == 0) ||
+         (sideB1 == 0 && distanceSqToSegment(b1, a0, a1) == 0) ||
+         (sideA0 == 0 && distanceSqToSegment(a0, b0, b1) == 0) ||
+         (sideA1 == 0 && distanceSqToSegment(a1, b0, b1) == 0);
+}
+
+bool PolygonCollision::contains(const sf::Vector2f *polygon, int count, sf::Vector2f point)
+{
+  // Count the edges crossed by a ray running along +x from the point.
+  bool inside = false;
+  for (int i = 0, j = count - 1; i < count; j = i++)
+  {
+    sf::Vector2f a = polygon[i];
+    sf::Vector2f b = polygon[j];
+    if ((a.y > point.y) != (b.y > point.y))
+    {
+      float crossX = a.x + (point.y - a.y) * (b.x - a.x) / (b.y - a.y);
+      if (point.x < crossX)
+      {
+        inside = !inside;
+      }
+    }
+  }
+  return inside;
+}
+
+bool PolygonCollision::circleHits(const sf::Vector2f *polygon, int count,
+                                  sf::Vector2f start, sf::Vector2f end, float radius)
+{
+  if (count <= 0)
+  {
+    return false;
+  }
+
+  // The path ends inside, or passes through an edge, or passes within
+  // the radius of one.  Starting inside means passing through an edge,
+  // unless the path ends inside too.
+  if (contains(polygon, count, end))
+  {
+    return true;
+  }
+  float radiusSq = radius * radius;
+  bool moved = start != end;
+  for (int i = 0, j = count - 1; i < count; j = i++)
+  {
+    sf::Vector2f a = polygon[j];
+    sf::Vector2f b = polygon[i];
+    if (distanceSqToSegment(end, a, b) < radiusSq)
+    {
+      return true;
+    }
+    if (moved)
+    {
+      if (segmentsCross(start, end, a, b) ||
+          distanceSqToSegment(start, a, b) < radiusSq ||
+          distanceSqToSegment(a, start, end) < radiusSq ||
+          distanceSqToSegment(b, start, end) < radiusSq)
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+float PolygonCollision::getInnerRadius(const sf::Vector2f *polygon, int count)
+{
+  float minDistanceSq = 0;
+  for (int i = 0, j = count - 1; i < count; j = i++)
+  {
+    float distanceSq = distanceSqToSegment(sf::Vector2f(), polygon[j], polygon[i]);
+    if (i == 0 || distanceSq < minDistanceSq)
+    {
+      minDistanceSq = distanceSq;
+    }
+  }
+  return sqrt(minDistanceSq);
+}
+
+// Collects the starts of the edges that come within the bounds, where
+// edge i runs from point i - 1 to point i.
+static int findEdgesNear(const sf::Vector2f *polygon, int count, const CollisionEnvelope &bounds, int *edges)
+{
+  int edgeCount = 0;
+  float radiusSq = bounds.radius * bounds.radius;
+  for (int i = 0, j = count - 1; i < count; j = i++)
+  {
+    if (distanceSqToSegment(bounds.center, polygon[j], polygon[i]) <= radiusSq)
+    {
+      edges[edgeCount++] = i;
+    }
+  }
+  return edgeCount;
+}
+
+bool PolygonCollision::polygonsOverlap(const sf::Vector2f *first, int firstCount, const CollisionEnvelope &firstBounds,
+                                       const sf::Vector2f *second, int secondCount, const CollisionEnvelope &secondBounds)
+{
+  if (firstCount <= 0 || secondCount <= 0 ||
+      firstCount > kMaxOutlinePoints || secondCount > kMaxOutlinePoints)
+  {
+    return false;
+  }
+
+  // Overlapping outlines either cross, or one holds the other whole.
+  // Only an edge that reaches into the other's bounds can cross it.
+  int firstEdges[kMaxOutlinePoints];
+  int secondEdges[kMaxOutlinePoints];
+  int firstEdgeCount = findEdgesNear(first, firstCount, secondBounds, firstEdges);
+  int secondEdgeCount = findEdgesNear(second, secondCount, firstBounds, secondEdges);
+  for (int edge = 0; edge < firstEdgeCount; edge++)
+  {
+    int i = firstEdges[edge];
+    sf::Vector2f a0 = first[i > 0 ? i - 1 : firstCount - 1];
+    sf::Vector2f a1 = first[i];
+    for (int otherEdge = 0; otherEdge < secondEdgeCount; otherEdge++)
+    {
+      int k = secondEdges[otherEdge];
+      if (segmentsCross(a0, a1, second[k > 0 ? k - 1 : secondCount - 1], second[k]))
+      {
+        return true;
+      }
+    }
+  }
+  return contains(second, secondCount, first[0]) || contains(first, firstCount, second[0]);
+}
@@ -0,0 +1,45 @@
+/**
+ * @file PolygonCollision.h
+ *
+ * Defines the exact collision tests for objects with an outline (see
+ * GraphObj::getCollisionOutline), used by the narrowphase once the
+ * bounding circles of a pair overlap.
+ *
+ * A polygon is a closed ring of points, in order, which needn't be
+ * convex.  Every test is a loop over the edges with no allocation, so
+ * with outlines of a dozen points it costs little more than the circle
+ * test it follows.
+ */
+
+#ifndef POLYGON_COLLISION_H_2026_10_17
+#define POLYGON_COLLISION_H_2026_10_17
+
+#include "GraphObj.h"
+
+namespace PolygonCollision
+{
+  // The most points an outline can have in the narrowphase; any beyond
+  // this are ignored.
+  static const int kMaxOutlinePoints = 16;
+
+  // True if the point is inside the polygon.
+  bool contains(const sf::Vector2f *polygon, int count, sf::Vector2f point);
+
+  // True if a circle of the given radius, moving in a straight line from
+  // start to end, touches the polygon anywhere along the way.  A circle
+  // that hasn't moved has start equal to end.
+  bool circleHits(const sf::Vector2f *polygon, int count,
+                  sf::Vector2f start, sf::Vector2f end, float radius);
+
+  // The radius of the largest circle about the origin that fits inside
+  // the polygon, for a polygon that holds the origin.
+  float getInnerRadius(const sf::Vector2f *polygon, int count);
+
+  // True if the two polygons overlap.  Each comes with a circle that
+  // holds it whole, so that only the edges that reach into the other's
+  // circle need testing.
+  bool polygonsOverlap(const sf::Vector2f *first, int firstCount, const CollisionEnvelope &firstBounds,
+                       const sf::Vector2f *second, int secondCount, const CollisionEnvelope &secondBounds);
+}
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @file Random.h
+ *
+ * Defines a small, fast, seedable random number generator (xoshiro128**).
+ * Each game box owns one and hands it to its objects through the update
+ * context, so a game started from the same seed plays out the same way,
+ * and separate games never share hidden state.
+ */
+
+#ifndef RANDOM_H_2026_10_17
+#define RANDOM_H_2026_10_17
+
+#include <stdint.h>
+
+class Random
+{
+public:
+  static const uint64_t kDefaultSeed = 0x5EED5EED5EED5EEDULL;
+
+  explicit Random(uint64_t seedValue = kDefaultSeed) { seed(seedValue); }
+
+  // Restarts the sequence.  The same seed always gives the same sequence.
+  void seed(uint64_t seedValue)
+  {
+    // Spread the seed over the whole state with splitmix64, so that
+    // nearby seeds give unrelated sequences.
+    for (int index = 0; index < 4; index += 2)
+    {
+      seedValue += 0x9E3779B97F4A7C15ULL;
+      uint64_t mixed = seedValue;
+      mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+      mixed ^= mixed >> 31;
+      mState[index] = (uint32_t)mixed;
+      mState[index + 1] = (uint32_t)(mixed >> 32);
+    }
+  }
+
+  uint32_t next()
+  {
+    uint32_t result = rotateLeft(mState[1] * 5, 7) * 9;
+    uint32_t shifted = mState[1] << 9;
+    mState[2] ^= mState[0];
+    mState[3] ^= mState[1];
+    mState[1] ^= mState[2];
+    mState[0] ^= mState[3];
+    mState[2] ^= shifted;
+    mState[3] = rotateLeft(mState[3], 11);
+    return result;
+  }
+
+  // A float in [0, 1)
+  float randFloat()
+  {
+    return (next() >> 8) * (1.0F / 16777216.0F);
+  }
+
+  float randFloat(float min, float max)
+  {
+    return min + randFloat() * (max - min);
+  }
+
+  // An int in [min, max]
+  int randInt(int min, int max)
+  {
+    if (max > min)
+    {
+      uint64_t range = (uint64_t)((int64_t)max - min + 1);
+      return min + (int)((next() * range) >> 32);
+    }
+    return min;
+  }
+
+  bool randBool()
+  {
+    return (next() >> 31) != 0;
+  }
+
+private:
+  static uint32_t rotateLeft(uint32_t value, int bits)
+  {
+    return (value << bits) | (value >> (32 - bits));
+  }
+
+  uint32_t mState[4];
+};
+
+#endif
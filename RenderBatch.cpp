@@ -0,0 +1,23 @@
+/**
+ * @file RenderBatch.cpp
+ *
+ * Implements the batch of world-space vertices drawn each frame.
+ */
+
+#include "RenderBatch.h"
+
+void RenderBatch::draw(sf::RenderTarget &target) const
+{
+  if (mGeometry.triangles.getVertexCount() > 0)
+  {
+    target.draw(mGeometry.triangles);
+  }
+  if (mGeometry.lines.getVertexCount() > 0)
+  {
+    target.draw(mGeometry.lines);
+  }
+  if (mGeometry.points.getVertexCount() > 0)
+  {
+    target.draw(mGeometry.points);
+  }
+}
@@ -0,0 +1,63 @@
+/**
+ * @file RenderBatch.h
+ *
+ * Defines a batch that collects the world-space vertices of every shape
+ * drawn in a frame, so the whole frame goes out in a handful of draw calls
+ * instead of one per shape.
+ *
+ * The batch holds the frame as one WorldGeometry: a triangle list for
+ * every filled shape, and a list each for lines and points.
+ */
+
+#ifndef RENDER_BATCH_H_2026_10_17
+#define RENDER_BATCH_H_2026_10_17
+
+#include <SFML/Graphics.hpp>
+#include "GraphObj.h"
+
+class RenderBatch
+{
+public:
+  RenderBatch() {}
+
+  // Empties the batch, keeping the buffers' capacity for the next frame.
+  void clear() { mGeometry.clear(); }
+
+  // Appends a model-space shape, placed at the given center and angle.
+  void addShape(const sf::VertexArray &shape, sf::Vector2f center, AngleFactors angleFact)
+  {
+    mGeometry.addShape(shape, center, angleFact);
+  }
+
+  // The frame so far, for placing shapes straight into.
+  WorldGeometry *getGeometry() { return &mGeometry; }
+
+  // Appends one triangle already in world space.
+  void addTriangle(const sf::Vertex &first, const sf::Vertex &second, const sf::Vertex &third)
+  {
+    mGeometry.triangles.append(first);
+    mGeometry.triangles.append(second);
+    mGeometry.triangles.append(third);
+  }
+
+  // Appends a rectangle already in world space, as two triangles.
+  void addRectangle(sf::Vector2f position, sf::Vector2f size, sf::Color color)
+  {
+    sf::Vertex topLeft(position, color);
+    sf::Vertex topRight(position + sf::Vector2f(size.x, 0), color);
+    sf::Vertex bottomRight(position + size, color);
+    sf::Vertex bottomLeft(position + sf::Vector2f(0, size.y), color);
+    addTriangle(topLeft, topRight, bottomRight);
+    addTriangle(topLeft, bottomRight, bottomLeft);
+  }
+
+  // Issues one draw call for each buffer that has anything in it.
+  void draw(sf::RenderTarget &target) const;
+
+  size_t getVertexCount() const { return mGeometry.getVertexCount(); }
+
+private:
+  WorldGeometry mGeometry;
+};
+
+#endif
@@ -6,6 +6,10 @@
 
 #include "Ship.h"
 #include "Bolt.h"
+#include "ObjectPool.h"
+#include "PolygonCollision.h"
+
+#include <algorithm>
 
 static const float kControlRotationsPerSecond = 0.75F;
 static const float kControlThrustShipLenPerSecSquared = 4.0F;
@@ -47,6 +51,13 @@ Ship::Ship(const Config &config) : VolatileObj(), mConfig(config)
   shipBody[1].color = kMediumGray;
   shipBody[2].color = kMediumGray;
   mCannonModelPt = shipBody[0].position;
+  for (int corner = 0; corner < 3; corner++)
+  {
+    mHullPoints[corner] = shipBody[corner].position;
+    float length = sqrt(mHullPoints[corner].x * mHullPoints[corner].x + mHullPoints[corner].y * mHullPoints[corner].y);
+    mBoundingRadius = std::max(mBoundingRadius, length);
+  }
+  mHullInnerRadius = PolygonCollision::getInnerRadius(mHullPoints, 3);
   mMainColor = kMediumGray;
 
   sf::VertexArray shipWindow(sf::Quads, 4);
@@ -99,6 +110,7 @@ Ship::Ship(const Config &config) : VolatileObj(), mConfig(config)
   mBoltConfig.color = kBoltColor;
   mBoltConfig.size = kBoltSizeFraction * mConfig.sizeRadius;
 
+  mType = ObjectType::Ship;
   mCollisionRadius = mConfig.sizeRadius;
 
   mFirePeriod = 1.0F / kMaxFireRate;
@@ -109,9 +121,13 @@ Ship::Ship(const Config &config) : VolatileObj(), mConfig(config)
   mExplosionRatio = kDefaultExplosionRatio;
 }
 
-void Ship::render(sf::RenderWindow &win)
+GraphObj::CollisionOutline Ship::getCollisionOutline() const
 {
-  GraphObj::render(win);
+  CollisionOutline outline;
+  outline.points = mHullPoints;
+  outline.pointCount = 3;
+  outline.innerRadius = mHullInnerRadius;
+  return outline;
 }
 
 void Ship::update(sf::Time deltaT, UpdateContext *context)
@@ -119,39 +135,42 @@ void Ship::update(sf::Time deltaT, UpdateContext *context)
   float deltaSeconds = deltaT.asSeconds();
   if (mControls.rotateLeft)
   {
-    mRadialVelocity = -kControlRotationsPerSecond * 2 * PI;
+    setRadialVelocity(-kControlRotationsPerSecond * 2 * PI);
   }
   else if (mControls.rotateRight)
   {
-    mRadialVelocity = kControlRotationsPerSecond * 2 * PI;
+    setRadialVelocity(kControlRotationsPerSecond * 2 * PI);
   }
   else
   {
-    mRadialVelocity = 0;
+    setRadialVelocity(0);
   }
 
   if (mMaxVelocity == 0)
   {
-    mLinearVelocity = sf::Vector2f(0, 0);
+    setLinearVelocity(sf::Vector2f(0, 0));
   }
   else
   {
     if (mControls.thrust)
     {
       float thrustDelta = deltaSeconds * kControlThrustShipLenPerSecSquared * mConfig.sizeRadius; 
-      float dx = cos(mAngleRadians) * thrustDelta;
-      float dy = sin(mAngleRadians) * thrustDelta;
-      mLinearVelocity.x += dx;
-      mLinearVelocity.y += dy;
-
-      float velocity = sqrt(mLinearVelocity.x * mLinearVelocity.x + mLinearVelocity.y * mLinearVelocity.y);
+      float angle = getAngle();
+      float dx = cos(angle) * thrustDelta;
+      float dy = sin(angle) * thrustDelta;
+      sf::Vector2f linearVelocity = getLinearVelocity();
+      linearVelocity.x += dx;
+      linearVelocity.y += dy;
+
+      float velocity = sqrt(linearVelocity.x * linearVelocity.x + linearVelocity.y * linearVelocity.y);
       if (velocity > mMaxVelocity)
       {
         // Clip the velocity, but don't change the direction of travel.
 
-        sf::Vector2f unitVelocity(mLinearVelocity.x / velocity, mLinearVelocity.y / velocity);
-        mLinearVelocity = unitVelocity * mMaxVelocity;
+        sf::Vector2f unitVelocity(linearVelocity.x / velocity, linearVelocity.y / velocity);
+        linearVelocity = unitVelocity * mMaxVelocity;
       }
+      setLinearVelocity(linearVelocity);
 
       mModelShapes[mExaustIndex].isVisible = true;
     }
@@ -172,11 +191,11 @@ void Ship::update(sf::Time deltaT, UpdateContext *context)
 
   if (mControls.fire && mFireWaitTime <= 0)
   {
-    auto bolt = std::make_shared<Bolt>(mBoltConfig);
+    auto bolt = makePooled<Bolt>(mBoltConfig);
     bolt->setPosition(modelToWorld(mCannonModelPt));
-    bolt->setOrientation(mAngleRadians);
+    bolt->setOrientation(getAngle());
     bolt->setLinearVelocity(getDirectionVector() * mBoltSpeed);
-    bolt->setTeam(mTeam); // Make sure we aren't blown up by our own fire
+    bolt->setTeam(getTeam()); // Make sure we aren't blown up by our own fire
     context->spawnList.push_back(bolt);
     mFireWaitTime = mFirePeriod;
   }
@@ -10,7 +10,7 @@
 #include "VolatileObj.h"
 #include "Bolt.h"
 
-class Ship : public VolatileObj
+class Ship final : public VolatileObj
 {
 public:
 
@@ -32,8 +32,6 @@ public:
 
   Ship(const Config &config);
 
-  void render(sf::RenderWindow &win) override;
-
   void updateControls(const Controls &controls)
   {
     mControls = controls;
@@ -43,11 +41,15 @@ public:
 
   bool explodesOnDeath() const override { return true; }
 
+  CollisionOutline getCollisionOutline() const override;
+
 private:
   Controls mControls;
   Config mConfig;
   int mExaustIndex = 0;
   sf::Vector2f mCannonModelPt;
+  sf::Vector2f mHullPoints[3]; // The body, for the polygon narrowphase
+  float mHullInnerRadius = 0;
   float mMaxVelocity = 0;
   float mBoltSpeed = 0;
   float mFireWaitTime = 0;
@@ -0,0 +1,28 @@
+/**
+ * @file ShipRespawn.cpp
+ *
+ * Implements the watch on a player's ship.
+ */
+
+#include "ShipRespawn.h"
+
+bool ShipRespawn::update(const GameBox &box, ObjectHandle ship, sf::Time now)
+{
+  const GraphObj *obj = box.getObject(ship);
+  if (!mWaiting)
+  {
+    // A stale handle is a death the player didn't see happen.
+    if (obj == nullptr || !obj->isAlive())
+    {
+      restart(now);
+    }
+    return false;
+  }
+
+  if (obj == nullptr && now - mWaitStart > mDelay)
+  {
+    mWaiting = false;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file ShipRespawn.h
+ *
+ * Defines the watch a player keeps on their ship, to know when the next
+ * one is due.  The ship is followed by its handle, so a ship that dies
+ * and is cleared out of the box between two checks - as happens when
+ * one update runs several fixed steps - still counts as a death.
+ */
+
+#ifndef SHIP_RESPAWN_H_2026_10_17
+#define SHIP_RESPAWN_H_2026_10_17
+
+#include <SFML/System/Time.hpp>
+#include "GameBox.h"
+
+class ShipRespawn
+{
+public:
+  // A new ship is due once the old one has been gone for the delay.
+  ShipRespawn(sf::Time delay) : mDelay(delay) {}
+
+  // Checks on the ship at the given time, returning true when a new ship
+  // is due.  The wait then ends, until the next ship dies.
+  bool update(const GameBox &box, ObjectHandle ship, sf::Time now);
+
+  // Starts the wait for a new ship over from the given time.
+  void restart(sf::Time now)
+  {
+    mWaiting = true;
+    mWaitStart = now;
+  }
+
+  bool isWaiting() const { return mWaiting; }
+
+private:
+  sf::Time mDelay;
+  bool mWaiting = false;
+  sf::Time mWaitStart;
+};
+
+#endif
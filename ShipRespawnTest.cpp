@@ -0,0 +1,71 @@
+/**
+ * @file ShipRespawnTest.cpp
+ *
+ * Checks that a player gets a new ship when theirs dies and is cleared
+ * out of the box before the player looks, as when one update runs
+ * several fixed steps.
+ */
+
+#include <stdio.h>
+#include <memory>
+
+#include "Asteroid.h"
+#include "GameBox.h"
+#include "Ship.h"
+#include "ShipRespawn.h"
+
+static int gFailures = 0;
+
+static void check(bool passed, const char *what)
+{
+  if (!passed)
+  {
+    printf("FAILED: %s\n", what);
+    gFailures++;
+  }
+}
+
+int main()
+{
+  GameBox box;
+  sf::Vector2u spaceSize(800, 600);
+  sf::Time tickTime = sf::milliseconds(10);
+  ShipRespawn respawn(sf::seconds(2));
+
+  Ship::Config shipConfig;
+  shipConfig.baseColor = sf::Color::Green;
+  shipConfig.sizeRadius = 20;
+  shipConfig.headToHead = false;
+  auto ship = std::make_shared<Ship>(shipConfig);
+  ship->setPosition(sf::Vector2f(400, 300));
+  ship->setTeam(0);
+  ObjectHandle shipHandle = box.add(ship);
+  ship.reset();
+
+  check(!respawn.update(box, shipHandle, sf::seconds(0)), "no new ship while the ship lives");
+  check(!respawn.isWaiting(), "no wait while the ship lives");
+
+  // A rock on top of the ship kills it in the first step, and the
+  // second clears it out, both before the player checks again.
+  Asteroid::Config asteroidConfig;
+  asteroidConfig.maxSize = 40;
+  asteroidConfig.minSize = 30;
+  asteroidConfig.color = sf::Color::Red;
+  auto asteroid = std::make_shared<Asteroid>(asteroidConfig, box.getRandom());
+  asteroid->setPosition(sf::Vector2f(400, 300));
+  asteroid->setTeam(1);
+  box.add(asteroid);
+  box.step(tickTime, spaceSize);
+  check(box.isPresent(shipHandle) && !box.getObject(shipHandle)->isAlive(), "the ship dies in the first step");
+  box.step(tickTime, spaceSize);
+  check(!box.isPresent(shipHandle), "the ship is cleared out in the second step");
+
+  check(!respawn.update(box, shipHandle, sf::seconds(1)), "no new ship straight away");
+  check(respawn.isWaiting(), "the wait starts when the ship is found gone");
+  check(!respawn.update(box, shipHandle, sf::seconds(2.9F)), "no new ship before the delay");
+  check(respawn.update(box, shipHandle, sf::seconds(3.1F)), "a new ship after the delay");
+  check(!respawn.isWaiting(), "the wait ends with the new ship");
+
+  printf("%s\n", gFailures == 0 ? "passed" : "failed");
+  return gFailures == 0 ? 0 : 1;
+}
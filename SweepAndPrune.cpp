@@ -0,0 +1,213 @@
+/**
+ * @file SweepAndPrune.cpp
+ *
+ * Implements the sort-and-sweep collision broadphase.
+ */
+
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+
+void SweepAndPrune::update(const std::vector<GraphObj *> &objects,
+                           const std::vector<CollisionEnvelope> &envelopes,
+                           sf::Vector2u spaceLimits)
+{
+  mSpaceLimits = sf::Vector2f((float)spaceLimits.x, (float)spaceLimits.y);
+
+  for (auto &body : mBodies)
+  {
+    body.index = -1;
+  }
+
+  for (size_t index = 0; index < objects.size(); index++)
+  {
+    int bodyIndex = 0;
+    auto found = mBodyOf.find(objects[index]);
+    if (found != mBodyOf.end())
+    {
+      bodyIndex = found->second;
+    }
+    else
+    {
+      if (!mFreeBodies.empty())
+      {
+        bodyIndex = mFreeBodies.back();
+        mFreeBodies.pop_back();
+      }
+      else
+      {
+        bodyIndex = (int)mBodies.size();
+        mBodies.push_back(Body());
+      }
+      mBodies[bodyIndex].obj = objects[index];
+      mBodyOf[objects[index]] = bodyIndex;
+
+      Endpoint endpoint;
+      endpoint.body = bodyIndex;
+      endpoint.isMin = true;
+      mEndpoints.push_back(endpoint);
+      endpoint.isMin = false;
+      mEndpoints.push_back(endpoint);
+    }
+
+    const CollisionEnvelope &envelope = envelopes[index];
+    Body &body = mBodies[bodyIndex];
+    body.index = (int)index;
+    body.minX = envelope.center.x - envelope.radius;
+    body.maxX = envelope.center.x + envelope.radius;
+    body.minY = envelope.center.y - envelope.radius;
+    body.maxY = envelope.center.y + envelope.radius;
+  }
+
+  // Drop the objects that have gone away
+  bool anyRemoved = false;
+  for (size_t bodyIndex = 0; bodyIndex < mBodies.size(); bodyIndex++)
+  {
+    Body &body = mBodies[bodyIndex];
+    if (body.index < 0 && body.obj != nullptr)
+    {
+      mBodyOf.erase(body.obj);
+      body.obj = nullptr;
+      mFreeBodies.push_back((int)bodyIndex);
+      anyRemoved = true;
+    }
+  }
+  if (anyRemoved)
+  {
+    mEndpoints.erase(
+      std::remove_if(mEndpoints.begin(), mEndpoints.end(),
+        [this](const Endpoint &endpoint) { return mBodies[endpoint.body].obj == nullptr; }),
+      mEndpoints.end());
+  }
+
+  for (auto &endpoint : mEndpoints)
+  {
+    const Body &body = mBodies[endpoint.body];
+    endpoint.value = endpoint.isMin ? body.minX : body.maxX;
+  }
+
+  sortEndpoints();
+}
+
+void SweepAndPrune::sortEndpoints()
+{
+  // Insertion sort - close to linear, as little moves between frames.
+  // Minimums go before maximums at the same value, so touching
+  // intervals are still reported.
+  for (size_t i = 1; i < mEndpoints.size(); i++)
+  {
+    Endpoint endpoint = mEndpoints[i];
+    size_t j = i;
+    while (j > 0 &&
+           (mEndpoints[j - 1].value > endpoint.value ||
+            (mEndpoints[j - 1].value == endpoint.value && !mEndpoints[j - 1].isMin && endpoint.isMin)))
+    {
+      mEndpoints[j] = mEndpoints[j - 1];
+      j--;
+    }
+    mEndpoints[j] = endpoint;
+  }
+}
+
+bool SweepAndPrune::overlapsY(const Body &a, const Body &b) const
+{
+  if (a.minY <= b.maxY && b.minY <= a.maxY)
+  {
+    return true;
+  }
+
+  // Space wraps around, so also try one interval shifted a span over.
+  float span = mSpaceLimits.y;
+  return (a.minY <= b.maxY + span && b.minY + span <= a.maxY) ||
+         (a.minY <= b.maxY - span && b.minY - span <= a.maxY);
+}
+
+void SweepAndPrune::addPair(int bodyA, int bodyB, std::vector<std::pair<int, int>> *pairs) const
+{
+  int indexA = mBodies[bodyA].index;
+  int indexB = mBodies[bodyB].index;
+  if (indexA != indexB && overlapsY(mBodies[bodyA], mBodies[bodyB]))
+  {
+    pairs->push_back(std::make_pair(std::min(indexA, indexB), std::max(indexA, indexB)));
+  }
+}
+
+void SweepAndPrune::findPairs(std::vector<std::pair<int, int>> *pairs) const
+{
+  if (pairs == nullptr)
+  {
+    return;
+  }
+
+  size_t firstPair = pairs->size();
+  mActive.clear();
+  mSeamBodies.clear();
+  for (auto &endpoint : mEndpoints)
+  {
+    if (endpoint.isMin)
+    {
+      for (int other : mActive)
+      {
+        addPair(other, endpoint.body, pairs);
+      }
+      mActive.push_back(endpoint.body);
+
+      const Body &body = mBodies[endpoint.body];
+      if (body.minX < 0 || body.maxX > mSpaceLimits.x)
+      {
+        mSeamBodies.push_back(endpoint.body);
+      }
+    }
+    else
+    {
+      auto found = std::find(mActive.begin(), mActive.end(), endpoint.body);
+      if (found != mActive.end())
+      {
+        *found = mActive.back();
+        mActive.pop_back();
+      }
+    }
+  }
+
+  if (mSeamBodies.empty())
+  {
+    return;
+  }
+
+  // Objects hanging over an edge of space also reach the objects at the
+  // opposite edge.  Those sit at the ends of the sorted array.
+  for (int seamBody : mSeamBodies)
+  {
+    const Body &body = mBodies[seamBody];
+    if (body.maxX > mSpaceLimits.x)
+    {
+      float wrappedMin = body.minX - mSpaceLimits.x;
+      float wrappedMax = body.maxX - mSpaceLimits.x;
+      for (size_t index = 0; index < mEndpoints.size() && mEndpoints[index].value <= wrappedMax; index++)
+      {
+        const Endpoint &endpoint = mEndpoints[index];
+        if (endpoint.isMin && mBodies[endpoint.body].maxX >= wrappedMin)
+        {
+          addPair(seamBody, endpoint.body, pairs);
+        }
+      }
+    }
+    if (body.minX < 0)
+    {
+      float wrappedMin = body.minX + mSpaceLimits.x;
+      float wrappedMax = body.maxX + mSpaceLimits.x;
+      for (size_t index = mEndpoints.size(); index > 0 && mEndpoints[index - 1].value >= wrappedMin; index--)
+      {
+        const Endpoint &endpoint = mEndpoints[index - 1];
+        if (!endpoint.isMin && mBodies[endpoint.body].minX <= wrappedMax)
+        {
+          addPair(seamBody, endpoint.body, pairs);
+        }
+      }
+    }
+  }
+
+  // A pair can overlap both directly and across the seam
+  std::sort(pairs->begin() + firstPair, pairs->end());
+  pairs->erase(std::unique(pairs->begin() + firstPair, pairs->end()), pairs->end());
+}
@@ -0,0 +1,68 @@
+/**
+ * @file SweepAndPrune.h
+ *
+ * Defines a sort-and-sweep collision broadphase.  The interval endpoints
+ * of every object on the x axis are kept in an array that persists from
+ * frame to frame.  Objects move only a little each frame, so the array
+ * stays nearly sorted and an insertion sort puts it back in order cheaply.
+ * Unlike a grid, this doesn't care how much object sizes vary.
+ */
+
+#ifndef SWEEP_AND_PRUNE_H_2026_10_17
+#define SWEEP_AND_PRUNE_H_2026_10_17
+
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include "GraphObj.h"
+
+class SweepAndPrune
+{
+public:
+  SweepAndPrune() {}
+
+  // Brings the endpoint array up to date with this frame's objects.
+  // Objects are matched to the previous frame by address; objects that
+  // are no longer present are dropped and new ones are added.
+  void update(const std::vector<GraphObj *> &objects,
+              const std::vector<CollisionEnvelope> &envelopes,
+              sf::Vector2u spaceLimits);
+
+  // Appends every candidate pair (first < second) of object indices,
+  // as given to the last update, whose bounds overlap.
+  void findPairs(std::vector<std::pair<int, int>> *pairs) const;
+
+private:
+  struct Body
+  {
+    const GraphObj *obj = nullptr;
+    int index = -1; // Index of the object in the last update, -1 if gone
+    float minX = 0;
+    float maxX = 0;
+    float minY = 0;
+    float maxY = 0;
+  };
+
+  struct Endpoint
+  {
+    float value = 0;
+    int body = 0;
+    bool isMin = true;
+  };
+
+  void sortEndpoints();
+  bool overlapsY(const Body &a, const Body &b) const;
+  void addPair(int bodyA, int bodyB, std::vector<std::pair<int, int>> *pairs) const;
+
+  std::vector<Body> mBodies;
+  std::vector<int> mFreeBodies;
+  std::vector<Endpoint> mEndpoints;
+  std::unordered_map<const GraphObj *, int> mBodyOf;
+  sf::Vector2f mSpaceLimits;
+
+  // Scratch space for findPairs
+  mutable std::vector<int> mActive;
+  mutable std::vector<int> mSeamBodies;
+};
+
+#endif
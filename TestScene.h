@@ -0,0 +1,129 @@
+/**
+ * @file TestScene.h
+ *
+ * A seeded asteroid field, with rocks on several teams and ships firing
+ * into it, and a record of where it ends up.  The tests run it twice,
+ * configured two ways, and check both runs end in the same place.
+ */
+
+#ifndef TEST_SCENE_H_2026_10_17
+#define TEST_SCENE_H_2026_10_17
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "AsteroidField.h"
+#include "Ship.h"
+
+// One object at the end of a run.  Everything is compared exactly: the
+// same collisions in the same order leave the same bits behind.
+struct TestObjectState
+{
+  ObjectType type = ObjectType::Other;
+  int team = 0;
+  bool alive = false;
+  sf::Vector2f position;
+  sf::Vector2f velocity;
+  float angle = 0;
+  float radialVelocity = 0;
+
+  bool operator==(const TestObjectState &other) const
+  {
+    return type == other.type && team == other.team && alive == other.alive &&
+           position == other.position && velocity == other.velocity &&
+           angle == other.angle && radialVelocity == other.radialVelocity;
+  }
+  bool operator!=(const TestObjectState &other) const { return !(*this == other); }
+
+  // Any order that doesn't depend on how the box found the objects
+  bool operator<(const TestObjectState &other) const
+  {
+    return std::make_tuple((int)type, team, position.x, position.y, angle) <
+           std::make_tuple((int)other.type, other.team, other.position.x, other.position.y, other.angle);
+  }
+};
+
+struct TestSceneResult
+{
+  std::vector<TestObjectState> objects; // Everything in the box at the end, sorted
+  std::vector<size_t> collisions;       // The collisions in each step
+  size_t peakCollisionTests = 0;        // The most pairs tested in a step
+};
+
+static const sf::Vector2u kTestSpaceSize(1920, 1080);
+static const uint64_t kTestSeed = 7;
+static const int kTestRockTeams = 4;
+static const int kTestShips = 4;
+
+// Fills the configured box and runs it for the given number of ticks.
+// Four teams of rocks crowd the space, so there are thousands of
+// candidate pairs in a step, enough for the update and the narrowphase
+// to be split over several threads.
+inline TestSceneResult runTestScene(AsteroidField *field, int ticks)
+{
+  field->getRandom().seed(kTestSeed);
+  for (int team = 0; team < kTestRockTeams; team++)
+  {
+    AsteroidField::FieldConfig fieldConfig;
+    fieldConfig.minAsteroids = 600;
+    fieldConfig.maxAsteroids = 600;
+    fieldConfig.maxLinearSpeed = 300;
+    fieldConfig.maxRadialSpeed = 2 * PI;
+    fieldConfig.minAsteroidSize = 10;
+    fieldConfig.maxAsteroidSize = 40;
+    fieldConfig.teamIndex = 1 + team;
+    field->populateField(fieldConfig, kTestSpaceSize);
+  }
+
+  Ship::Config shipConfig;
+  shipConfig.baseColor = sf::Color::Green;
+  shipConfig.sizeRadius = 20;
+  shipConfig.headToHead = false;
+  Ship::Controls controls;
+  controls.rotateLeft = true;
+  controls.fire = true;
+  for (int index = 0; index < kTestShips; index++)
+  {
+    auto ship = std::make_shared<Ship>(shipConfig);
+    ship->setPosition(sf::Vector2f(kTestSpaceSize.x * (index + 1) / (kTestShips + 1.0F), kTestSpaceSize.y / 2.0F));
+    ship->setTeam(1 + kTestRockTeams + index);
+    ship->updateControls(controls);
+    field->add(ship);
+  }
+
+  TestSceneResult result;
+  sf::Time tickTime = sf::milliseconds(10);
+  for (int tick = 0; tick < ticks; tick++)
+  {
+    field->step(tickTime, kTestSpaceSize);
+    const GameBox::StepCounts &counts = field->getLastStepCounts();
+    result.collisions.push_back(counts.collisions);
+    if (counts.collisionTests > result.peakCollisionTests)
+    {
+      result.peakCollisionTests = counts.collisionTests;
+    }
+  }
+
+  // A circle from the middle that reaches every corner holds everything
+  std::vector<GraphObj *> found;
+  sf::Vector2f middle(kTestSpaceSize.x / 2.0F, kTestSpaceSize.y / 2.0F);
+  field->queryRadius(middle, (float)(kTestSpaceSize.x + kTestSpaceSize.y), kTestSpaceSize, &found);
+  for (auto obj : found)
+  {
+    TestObjectState state;
+    state.type = obj->getType();
+    state.team = obj->getTeam();
+    state.alive = obj->isAlive();
+    state.position = obj->getPosition();
+    state.velocity = obj->getLinearVelocity();
+    state.angle = obj->getAngle();
+    state.radialVelocity = obj->getRadialVelocity();
+    result.objects.push_back(state);
+  }
+  std::sort(result.objects.begin(), result.objects.end());
+  return result;
+}
+
+#endif
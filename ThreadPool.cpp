@@ -0,0 +1,95 @@
+/**
+ * @file ThreadPool.cpp
+ *
+ * Implements the pool of worker threads.
+ */
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount)
+{
+  if (threadCount <= 0)
+  {
+    threadCount = (int)std::thread::hardware_concurrency();
+  }
+  for (int index = 1; index < threadCount; index++)
+  {
+    mWorkers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mWorkReady.notify_all();
+  for (auto &worker : mWorkers)
+  {
+    worker.join();
+  }
+}
+
+void ThreadPool::runChunks()
+{
+  int chunk = mNextChunk.fetch_add(1);
+  while (chunk < mChunkCount)
+  {
+    (*mTask)(chunk);
+    chunk = mNextChunk.fetch_add(1);
+  }
+}
+
+void ThreadPool::workerLoop()
+{
+  unsigned int seenGeneration = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mWorkReady.wait(lock, [&] { return mStopping || mGeneration != seenGeneration; });
+      if (mStopping)
+      {
+        return;
+      }
+      seenGeneration = mGeneration;
+    }
+
+    runChunks();
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mBusyWorkers--;
+    }
+    mWorkDone.notify_one();
+  }
+}
+
+void ThreadPool::run(int chunkCount, const std::function<void(int)> &task)
+{
+  if (mWorkers.empty() || chunkCount <= 1)
+  {
+    for (int chunk = 0; chunk < chunkCount; chunk++)
+    {
+      task(chunk);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTask = &task;
+    mChunkCount = chunkCount;
+    mNextChunk = 0;
+    mBusyWorkers = (int)mWorkers.size();
+    mGeneration++;
+  }
+  mWorkReady.notify_all();
+
+  runChunks();
+
+  std::unique_lock<std::mutex> lock(mMutex);
+  mWorkDone.wait(lock, [&] { return mBusyWorkers == 0; });
+  mTask = nullptr;
+}
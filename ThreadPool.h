@@ -0,0 +1,52 @@
+/**
+ * @file ThreadPool.h
+ *
+ * Defines a simple pool of worker threads for splitting a pass over the
+ * game objects into chunks that run at the same time.
+ */
+
+#ifndef THREAD_POOL_H_2026_10_17
+#define THREAD_POOL_H_2026_10_17
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+  // A thread count of zero uses one thread per hardware core.  The
+  // calling thread counts as one of the threads.
+  explicit ThreadPool(int threadCount = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int getThreadCount() const { return (int)mWorkers.size() + 1; }
+
+  // Calls task(chunkIndex) for every chunk in [0, chunkCount), spread
+  // over the pool and the calling thread.  Returns once all are done.
+  void run(int chunkCount, const std::function<void(int)> &task);
+
+private:
+  void workerLoop();
+  void runChunks();
+
+  std::vector<std::thread> mWorkers;
+  std::mutex mMutex;
+  std::condition_variable mWorkReady;
+  std::condition_variable mWorkDone;
+
+  const std::function<void(int)> *mTask = nullptr;
+  int mChunkCount = 0;
+  std::atomic<int> mNextChunk{ 0 };
+  int mBusyWorkers = 0;
+  unsigned int mGeneration = 0;
+  bool mStopping = false;
+};
+
+#endif
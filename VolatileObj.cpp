@@ -8,6 +8,8 @@
 
 #include "VolatileObj.h"
 #include "Fragment.h"
+#include "ObjectPool.h"
+#include "ParticleSystem.h"
 
 static const int kMinExplosionFragments = 3;
 static const int kMaxExplosionFragments = 7;
@@ -27,7 +29,7 @@ static const float kMinFragmentLifeSeconds = 0.5;
 static const float kMaxFragmentLifeSeconds = 2;
 static const sf::Color kFireColor = kOrange;
 
-void VolatileObj::throwObjRand(std::shared_ptr<GraphObj> obj, ThrowStyle throwStyle)
+void VolatileObj::throwObjRand(std::shared_ptr<GraphObj> obj, Random &random, ThrowStyle throwStyle)
 {
   KnockConfig knock;
 
@@ -48,38 +50,85 @@ void VolatileObj::throwObjRand(std::shared_ptr<GraphObj> obj, ThrowStyle throwSt
 
   obj->setPosition(getPosition());
   obj->setLinearVelocity(getLinearVelocity());
-  obj->knockRand(knock);
+  obj->knockRand(knock, random);
 }
 
-std::list<std::shared_ptr<GraphObj>> VolatileObj::explode()
+void VolatileObj::explode(std::vector<std::shared_ptr<GraphObj>> *ejecta, UpdateContext *context)
 {
-  std::list<std::shared_ptr<GraphObj>> ejecta;
+  if (context && context->particles)
+  {
+    throwParticles(*context->particles);
+  }
+  else if (ejecta && context && context->random)
+  {
+    // No particle system - throw full fragment objects instead
+    Random &random = *context->random;
+    int fragments = random.randInt((int)(kMinExplosionFragments * mExplosionRatio), (int)(kMaxExplosionFragments * mExplosionRatio));
+    for (int fragIndex = 0; fragIndex < fragments; fragIndex++)
+    {
+      Fragment::Config fragmentConfig;
+      fragmentConfig.lifespanSeconds = random.randFloat(kMinFragmentLifeSeconds, kMaxFragmentLifeSeconds);
+
+      if (mExplodeStyle == ExplodeStyle::FireAndFragments && random.randInt(0, 2) == 0)
+      {
+        fragmentConfig.color = getMainColor();
+        fragmentConfig.size = random.randFloat(kMinBodyFragmentSize, kMaxBodyFragmentSize);
+        fragmentConfig.isFire = false;
+      }
+      else
+      {
+        fragmentConfig.color = kFireColor;
+        fragmentConfig.size = random.randFloat(kMinFireFragmentSize, kMaxFireFragmentSize);
+        fragmentConfig.isFire = true;
+      }
+
+      auto fragment = makePooled<Fragment>(fragmentConfig, random);
+      throwObjRand(fragment, random, ThrowStyle::Explosion);
+      ejecta->push_back(fragment);
+    }
+  }
+  kill();
+}
 
-  int fragments = randInt(kMinExplosionFragments * mExplosionRatio, kMaxExplosionFragments * mExplosionRatio);
+void VolatileObj::throwParticles(ParticleSystem &particles)
+{
+  Random &random = particles.getRandom();
+  float detail = particles.getDetail();
+  if (detail <= 0)
+  {
+    return;
+  }
+  float lifespanScale = particles.getLifespanScale(detail);
+
+  KnockConfig knock;
+  knock.minLinearSpeed = kMinExplosionSpeed;
+  knock.maxLinearSpeed = kMaxExplosionSpeed;
+  knock.minRadialSpeed = kMinExplosionRadialSpeed;
+  knock.maxRadialSpeed = kMaxExplosionRadialSpeed;
+
+  int fragments = random.randInt((int)(kMinExplosionFragments * mExplosionRatio), (int)(kMaxExplosionFragments * mExplosionRatio));
+  fragments = (int)(fragments * detail + 0.5F);
   for (int fragIndex = 0; fragIndex < fragments; fragIndex++)
   {
-    Fragment::Config fragmentConfig;
-    fragmentConfig.lifespanSeconds = randFloat(kMinFragmentLifeSeconds, kMaxFragmentLifeSeconds);
+    float lifespanSeconds = random.randFloat(kMinFragmentLifeSeconds, kMaxFragmentLifeSeconds) * lifespanScale;
 
-    if (mExplodeStyle == ExplodeStyle::FireAndFragments && rand() % 3 == 0)
+    ParticleSystem::Particle particle;
+    if (mExplodeStyle == ExplodeStyle::FireAndFragments && random.randInt(0, 2) == 0)
     {
-      fragmentConfig.color = getMainColor();
-      fragmentConfig.size = randFloat(kMinBodyFragmentSize, kMaxBodyFragmentSize);
-      fragmentConfig.isFire = false;
+      particle = ParticleSystem::makeFragment(random.randFloat(kMinBodyFragmentSize, kMaxBodyFragmentSize), getMainColor(), random);
     }
     else
     {
-      fragmentConfig.color = kFireColor;
-      fragmentConfig.size = randFloat(kMinFireFragmentSize, kMaxFireFragmentSize);
-      fragmentConfig.isFire = true;
+      particle = ParticleSystem::makeFire(random.randFloat(kMinFireFragmentSize, kMaxFireFragmentSize), kFireColor);
     }
+    particle.remainingLifeSeconds = lifespanSeconds;
 
-    auto fragment = std::make_shared<Fragment>(fragmentConfig);
-    throwObjRand(fragment, ThrowStyle::Explosion);
-
-    ejecta.push_back(fragment);
+    // Thrown as throwObjRand throws a fragment object
+    Knock thrown = randKnock(knock, 1, random);
+    particle.position = getPosition() + thrown.jump;
+    particle.velocity = getLinearVelocity() + thrown.linearVelocity;
+    particle.radialVelocity = thrown.radialVelocity;
+    particle.angle = thrown.angle;
+    particles.emit(particle);
   }
-  kill();
-
-  return ejecta;
-}
\ No newline at end of file
+}
@@ -14,7 +14,7 @@ class VolatileObj : public GraphObj
 public:
   VolatileObj() {}
 
-  virtual std::list<std::shared_ptr<GraphObj>> explode();
+  void explode(std::vector<std::shared_ptr<GraphObj>> *ejecta, UpdateContext *context) override;
 
   void setExplosionRatio(float ratio) { mExplosionRatio = ratio; }
   float getExplosionRatio() { return mExplosionRatio; }
@@ -25,7 +25,11 @@ protected:
     Explosion,
     Breakup
   };
-  void throwObjRand(std::shared_ptr<GraphObj> obj, ThrowStyle throwStyle = ThrowStyle::Explosion);
+  void throwObjRand(std::shared_ptr<GraphObj> obj, Random &random, ThrowStyle throwStyle = ThrowStyle::Explosion);
+
+  // Throws the explosion's fragments out as particles, as many as the
+  // particle system's level of detail allows.
+  void throwParticles(ParticleSystem &particles);
 
   enum class ExplodeStyle
   {